@@ -0,0 +1,331 @@
+#ifndef _APPROX_SCORE_H_
+#define _APPROX_SCORE_H_
+#include "Lib.hpp"
+#include "Random.hpp"
+#include "ScoreCache.hpp"
+#include <cmath>
+
+/*
+辺の標本からcalc_score<Policy>を推定する (大きなグラフで受理の判定に使う)
+辺の長さの項(length, naname)は厳密に計算し,
+貫通の項(penetration)と交差の項(cross)は辺の標本から推定する
+辺は始点の列で層に分け, 各層から大きさに比例した本数を非復元抽出する (層化抽出)
+各辺の値 := (その辺の無視できない貫通に関与する長さ) * penetration + (その辺と交差する辺の数) / 2 * cross
+推定値 := sum_h (層hの辺数 / 層hの標本数) * (層hの標本の値の和)
+bound  := 推定値の標準誤差 * z (z = 1.96 でおよそ95%の信頼区間の半分の幅)
+標本は resample() を呼ぶまで固定なので, 同じ配置には同じ推定値を返す
+貫通の長さは逐次版と同じく1回ずつintに切り捨てて足すので, 標本が全ての辺なら厳密な値と一致する
+
+reset(pos) で配置を覚えて全体を計算し O(N + M + (標本数) * (辺の長さ + [cross != 0] * M)),
+以降は swap(a, b) で2つの工程の位置を入れ替えながら, 変わる部分だけ計算し直す
+  長さの項 : aとbに接続する辺だけ
+  標本の値 : aかbに接続する辺と, aかbの位置を通る辺だけ (交差の数はaとbに接続する辺との分だけ)
+*/
+template<typename Policy = ScorePolicyDefault>
+struct ApproxScore {
+    struct Estimate {
+        double score; // 推定値
+        double bound; // 信頼区間の半分の幅
+    };
+
+    int N, M, S;
+    double z;
+    const std::vector<std::pair<int, int>> &E;
+    std::vector<std::vector<int>> strata; // 層ごとの辺の番号
+    std::vector<int> off, adj; // 工程ごとの行き先 (昇順)
+    std::vector<int> ioff, inc; // 工程ごとに接続する辺の番号
+    // 標本 (層ごとに連続して並べる)
+    std::vector<int> sample, sample_h; // 辺の番号, 層
+    std::vector<int> ns; // 層ごとの標本の数
+    std::vector<int> pen, crs; // 標本の辺の貫通の長さ, 交差の数
+    std::vector<double> sum, sum2; // 層ごとの標本の値の和, 2乗和
+    std::vector<std::pair<int, int>> pos; // 現在の配置
+    double exact; // 現在の配置の長さの項
+    int H; // ハッシュ表の大きさ (2の冪)
+    std::vector<uint64_t> key;
+    std::vector<int> val;
+    // swapの作業用
+    std::vector<int> mark, changed, touched; // 変わる辺の印, 変わる辺, 値が変わりうる標本
+    std::vector<char> dirty;
+    std::vector<double> before;
+    int stamp = 0;
+
+    // X := 各工程の列 (calc_min_x), samples := 標本の大きさ(辺の本数)
+    ApproxScore(int _N, const std::vector<std::pair<int, int>> &_E, const std::vector<int> &X, int samples, double _z = 1.96)
+        : N(_N), M(_E.size()), S(samples), z(_z), E(_E), mark(_E.size(), 0) {
+        strata.resize(N);
+        for (int i = 0; i < M; i++) strata[X[E[i].first]].push_back(i);
+        strata.erase(std::remove_if(strata.begin(), strata.end(), [](const std::vector<int> &v) { return v.empty(); }), strata.end());
+        off.assign(N + 1, 0);
+        for (auto [s, t] : E) off[s + 1]++;
+        for (int i = 0; i < N; i++) off[i + 1] += off[i];
+        adj.resize(M);
+        std::vector<int> cur(off.begin(), off.end() - 1);
+        for (auto [s, t] : E) adj[cur[s]++] = t;
+        for (int i = 0; i < N; i++) std::sort(adj.begin() + off[i], adj.begin() + off[i + 1]);
+        ioff.assign(N + 1, 0);
+        for (auto [s, t] : E) ioff[s + 1]++, ioff[t + 1]++;
+        for (int i = 0; i < N; i++) ioff[i + 1] += ioff[i];
+        inc.resize(2 * M);
+        cur.assign(ioff.begin(), ioff.end() - 1);
+        for (int i = 0; i < M; i++) {
+            inc[cur[E[i].first]++] = i;
+            inc[cur[E[i].second]++] = i;
+        }
+        H = 1;
+        while (H < 2 * N) H *= 2;
+        resample();
+    }
+
+    // 標本を取り直す (次にreset()を呼ぶまで推定値は使えない)
+    void resample() {
+        sample.clear();
+        sample_h.clear();
+        ns.assign(strata.size(), 0);
+        for (int h = 0; h < strata.size(); h++) {
+            int sz = strata[h].size();
+            int n = ns[h] = std::min(sz, std::max(2, int((long long)S * sz / std::max(M, 1))));
+            auto v = strata[h];
+            // 先頭n個を一様ランダムに選ぶ
+            for (int i = 0; i < n; i++) std::swap(v[i], v[i + rng.random_number() % (sz - i)]);
+            for (int i = 0; i < n; i++) {
+                sample.push_back(v[i]);
+                sample_h.push_back(h);
+            }
+        }
+        pen.assign(sample.size(), 0);
+        crs.assign(sample.size(), 0);
+    }
+
+    bool has_edge(int s, int t) const {
+        return std::binary_search(adj.begin() + off[s], adj.begin() + off[s + 1], t);
+    }
+
+    static uint64_t cell(int x, int y) {
+        return (uint64_t(uint32_t(x)) << 32) | uint32_t(y);
+    }
+
+    // 格子点(x, y)の表の位置
+    int slot(int x, int y) const {
+        uint64_t k = cell(x, y);
+        int h = Zobrist::mix(k) & (H - 1);
+        while (val[h] != -1 && key[h] != k) h = (h + 1) & (H - 1);
+        return h;
+    }
+
+    // 格子点(x, y)にある工程, 無ければ-1
+    int find(int x, int y) const {
+        return val[slot(x, y)];
+    }
+
+    void build_table() {
+        key.assign(H, 0);
+        val.assign(H, -1);
+        for (int v = 0; v < N; v++) {
+            int h = slot(pos[v].first, pos[v].second);
+            if (val[h] != -1) continue; // 同じ位置に複数ある場合は番号が小さい方 (逐次版と同じ)
+            key[h] = cell(pos[v].first, pos[v].second);
+            val[h] = v;
+        }
+    }
+
+    // i番目の辺の長さの項
+    double edge_length(int i) const {
+        auto [s, t] = E[i];
+        int dx = pos[t].first - pos[s].first;
+        int dy = pos[t].second - pos[s].second;
+        double len = std::sqrt(dx * dx + dy * dy);
+        double res = 0;
+        if constexpr (Policy::length != 0) res += Policy::length * len;
+        if constexpr (Policy::naname != 0) res += (dy != 0 ? Policy::naname * len : 0);
+        return res;
+    }
+
+    // i番目の辺の無視できない貫通に関与する長さ
+    int penetration(int i) const {
+        auto [s, t] = E[i];
+        int dx = pos[t].first - pos[s].first;
+        int dy = pos[t].second - pos[s].second;
+        int g = std::gcd(dx, dy);
+        dx /= g;
+        dy /= g;
+        int x = pos[s].first + dx, y = pos[s].second + dy;
+        int v = s;
+        int dxsum = dx, dysum = dy;
+        int len = 0; // 逐次版と同じく足すたびに切り捨てる
+        while (x != pos[t].first) {
+            int next = find(x, y);
+            if (next != -1) {
+                if (!has_edge(v, next)) len += std::sqrt(dxsum * dxsum + dysum * dysum);
+                v = next;
+            }
+            x += dx;
+            y += dy;
+            dxsum += dx;
+            dysum += dy;
+        }
+        return len;
+    }
+
+    // i番目の辺が格子点(x, y)を端点以外で通るか
+    bool passes(int i, int x, int y) const {
+        auto [sx, sy] = pos[E[i].first];
+        auto [tx, ty] = pos[E[i].second];
+        return sx < x && x < tx && (long long)(y - sy) * (tx - sx) == (long long)(x - sx) * (ty - sy);
+    }
+
+    // i番目とj番目の辺が交差するか (count_edge_crossと同じ判定)
+    bool crosses(int i, int j) const {
+        auto [ax, ay] = pos[E[i].first];
+        auto [bx, by] = pos[E[i].second];
+        auto [cx, cy] = pos[E[j].first];
+        auto [dx, dy] = pos[E[j].second];
+        double s1 = double(by - ay) / (bx - ax);
+        double s2 = double(dy - cy) / (dx - cx);
+        if (s1 == s2) return false;
+        double cross_x = (s1 * ax - ay - s2 * cx + cy) / (s1 - s2);
+        return ax < cross_x && cross_x < bx && cx < cross_x && cross_x < dx;
+    }
+
+    // i番目の辺と交差する辺の数
+    int count_cross(int i) const {
+        int cnt = 0;
+        for (int j = 0; j < M; j++) {
+            if (j != i && crosses(i, j)) cnt++;
+        }
+        return cnt;
+    }
+
+    // 標本のk番目の値
+    double value(int k) const {
+        double res = 0;
+        if constexpr (Policy::penetration != 0) res += Policy::penetration * pen[k];
+        if constexpr (Policy::cross != 0) res += Policy::cross * crs[k] / 2;
+        return res;
+    }
+
+    // 層hの辺数sz, 標本数n, 標本の値の和と2乗和から (推定値, 分散)
+    static std::pair<double, double> stratum(int sz, int n, double s, double s2) {
+        double var = 0;
+        // 有限母集団修正つきの層別の分散
+        if (n >= 2 && n < sz) {
+            double v = std::max(0.0, (s2 - s * s / n) / (n - 1));
+            var = double(sz) * sz * (1 - double(n) / sz) * v / n;
+        }
+        return {double(sz) / n * s, var};
+    }
+
+    // 配置をposにして全体を計算し直し, 推定値を返す
+    Estimate reset(const std::vector<std::pair<int, int>> &_pos) {
+        pos = _pos;
+        exact = 0;
+        if constexpr (Policy::length != 0 || Policy::naname != 0) {
+            for (int i = 0; i < M; i++) exact += edge_length(i);
+        }
+        if constexpr (Policy::penetration != 0) build_table();
+        sum.assign(strata.size(), 0);
+        sum2.assign(strata.size(), 0);
+        for (int k = 0; k < sample.size(); k++) {
+            if constexpr (Policy::penetration != 0) pen[k] = penetration(sample[k]);
+            if constexpr (Policy::cross != 0) crs[k] = count_cross(sample[k]);
+            double f = value(k);
+            sum[sample_h[k]] += f;
+            sum2[sample_h[k]] += f * f;
+        }
+        return estimate();
+    }
+
+    // 現在の配置の推定値
+    Estimate estimate() const {
+        double est = 0, var = 0;
+        if constexpr (Policy::penetration != 0 || Policy::cross != 0) {
+            for (int h = 0; h < strata.size(); h++) {
+                auto [e, v] = stratum(strata[h].size(), ns[h], sum[h], sum2[h]);
+                est += e;
+                var += v;
+            }
+        }
+        return {exact + est, z * std::sqrt(var)};
+    }
+
+    /*
+    工程aとbの位置を入れ替え, 入れ替えによるスコアの変化の推定値を返す
+    前後を同じ標本で比べるので, boundは変化量の信頼区間の半分の幅 (標本の値の差の分散から求める)
+    もう一度同じ引数で呼ぶと元に戻る
+    aとbの位置以外に工程が重なっていないこと
+    */
+    Estimate swap(int a, int b) {
+        if (pos[a] == pos[b]) return {0, 0};
+        stamp++;
+        changed.clear();
+        for (int v : {a, b}) {
+            for (int p = ioff[v]; p < ioff[v + 1]; p++) {
+                if (mark[inc[p]] != stamp) {
+                    mark[inc[p]] = stamp;
+                    changed.push_back(inc[p]);
+                }
+            }
+        }
+        // 値が変わりうる標本 (交差の項があれば全て, 無ければdirtyなものだけ)
+        // dirty := aかbに接続する辺か, aかbの位置を通る辺 (貫通の長さを計算し直す)
+        touched.clear();
+        dirty.clear();
+        for (int k = 0; k < sample.size(); k++) {
+            int i = sample[k];
+            bool d = mark[i] == stamp;
+            if constexpr (Policy::penetration != 0) {
+                d = d || passes(i, pos[a].first, pos[a].second) || passes(i, pos[b].first, pos[b].second);
+            }
+            if (d || Policy::cross != 0) {
+                touched.push_back(k);
+                dirty.push_back(d);
+            }
+        }
+        before.resize(touched.size());
+        for (int d = 0; d < touched.size(); d++) before[d] = value(touched[d]);
+        double diff = 0;
+        for (int i : changed) diff -= edge_length(i);
+        if constexpr (Policy::cross != 0) {
+            for (int k : touched) {
+                if (mark[sample[k]] == stamp) continue;
+                for (int j : changed) crs[k] -= crosses(sample[k], j);
+            }
+        }
+
+        if constexpr (Policy::penetration != 0) {
+            int ha = slot(pos[a].first, pos[a].second), hb = slot(pos[b].first, pos[b].second);
+            if (val[ha] == a) val[ha] = b;
+            if (val[hb] == b) val[hb] = a;
+        }
+        std::swap(pos[a], pos[b]);
+
+        for (int i : changed) diff += edge_length(i);
+        exact += diff;
+        // 層ごとに標本の値の差の和と2乗和をまとめる (touchedは層の順に並んでいる)
+        double var = 0;
+        for (int d = 0; d < touched.size();) {
+            int h = sample_h[touched[d]];
+            double ds = 0, ds2 = 0;
+            for (; d < touched.size() && sample_h[touched[d]] == h; d++) {
+                int k = touched[d], i = sample[k];
+                if (dirty[d]) {
+                    if constexpr (Policy::penetration != 0) pen[k] = penetration(i);
+                }
+                if constexpr (Policy::cross != 0) {
+                    if (mark[i] == stamp) crs[k] = count_cross(i);
+                    else for (int j : changed) crs[k] += crosses(i, j);
+                }
+                double f = value(k), f0 = before[d];
+                ds += f - f0;
+                ds2 += (f - f0) * (f - f0);
+                sum[h] += f - f0;
+                sum2[h] += f * f - f0 * f0;
+            }
+            auto [e, v] = stratum(strata[h].size(), ns[h], ds, ds2);
+            diff += e;
+            var += v;
+        }
+        return {diff, z * std::sqrt(var)};
+    }
+};
+#endif
@@ -0,0 +1,42 @@
+#include "CheckLib.hpp"
+#include "Lib.hpp"
+#include "Engine.hpp"
+#include "ParallelScore.hpp"
+
+// 重心法による交差削減
+// 山登り法の初期解にも使える (Engine.hppのsolve_barycenter_climbing)
+int main() {
+    std::string path_in = "../testcase/case1.csv";
+    std::string path_out = "../testcase/case1_bc.csv";
+    assert(CheckLib::is_valid_input(path_in));
+    std::vector<std::pair<int, int>> E;
+    ProcessMap mp;
+    for (auto [s, t] : CheckLib::read_csv(path_in)) {
+        int sid = mp.register_process(s);
+        int tid = mp.register_process(t);
+        E.push_back({sid, tid});
+    }
+
+    E = remove_multiple_edge(E);
+    renumber(mp, E);
+    int N = mp.size();
+    ProblemContext ctx(N, E);
+    // 横軸はcalc_min_x, 縦方向は列ごとの並び順を交差削減で決める
+    auto pos = solve_barycenter(ctx);
+
+    // スコア計算
+    auto metrics = evaluate_layout_parallel(pos, E, LayoutMetrics::required<ScorePolicyDefault>() | LayoutMetrics::Cross | LayoutMetrics::BadPenetration);
+    double score = metrics.score<ScorePolicyDefault>();
+    std::cout << "score is " << score << '\n';
+    std::cout << "lensum is " << metrics.length << '\n';
+    std::cout << "cross is " << metrics.cross << '\n';
+    std::cout << "penetration is " << metrics.bad_penetration << '\n';
+
+
+    // 答えを作成
+    std::vector<std::tuple<std::string, int, int>> P(N);
+    for (int i = 0; i < N; i++) {
+        P[i] = {mp.get_process(i), pos[i].first, pos[i].second};
+    }
+    CheckLib::write_csv(path_out, P);
+}
\ No newline at end of file
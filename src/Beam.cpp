@@ -3,6 +3,8 @@
 #include "Random.hpp"
 #include "BeamSearch.hpp"
 #include "SimulatedAnnealing.hpp"
+#include "ParallelScore.hpp"
+#include "ProblemContext.hpp"
 
 std::vector<std::pair<int, int>> Ord;
 std::vector<std::pair<int, int>> E2;
@@ -72,62 +74,82 @@ int main() {
     }
 
     E = remove_multiple_edge(E);
+    renumber(mp, E);
     int N = mp.size();
-    auto G = adjacency_list(N, E);
+    ProblemContext ctx(N, E);
     // 各工程の横軸の座標を決定
-    auto X = calc_min_x(G);
-    Xcnt.resize(N, 0);
+    const auto &X = ctx.min_x();
+    Xcnt = ctx.column_count();
 
+    // renumberで番号はXの昇順になっているので, 番号順にそのまま置いていけばよい
     for (int i = 0; i < N; i++) {
         Ord.push_back({i, X[i]});
-        Xcnt[X[i]]++;
-    }
-
-    std::sort(Ord.begin(), Ord.end(), [&](auto a, auto b) { return a.second < b.second; });
-
-    std::vector<int> rev(N);
-    for (int i = 0; i < N; i++) {
-        auto [id, x] = Ord[i];
-        rev[id] = i;
-    }
-
-    for (auto [s, t] : E) {
-        E2.push_back({rev[s], rev[t]});
     }
 
+    E2 = E;
     std::sort(E2.begin(), E2.end(), [&](auto a, auto b) { return a.second < b.second; });
 
-    MyState s;
-    auto U = beam_search<timer<0>, MyState, MyCmp>()(s, 50, 2000);
-    for (auto u : U) {
-        s = s.update(u);
-    }
+    // 操作列から配置を作る
+    // 途中までの操作列の場合, まだ置かれていない工程はその列の空いている位置に上から詰める
+    auto make_pos = [&](const std::vector<MyState::Update> &U) {
+        std::vector<std::pair<int, int>> pos(N);
+        std::vector<bool> placed(N, false);
+        std::vector<std::vector<bool>> used(N);
+        for (auto [i, x, y] : U) {
+            auto [id, _x] = Ord[i];
+            pos[id] = {x, y};
+            placed[id] = true;
+            if (used[x].size() <= y) used[x].resize(y + 1, false);
+            used[x][y] = true;
+        }
+        for (int i = 0; i < N; i++) {
+            if (placed[i]) continue;
+            int x = X[i], y = 0;
+            while (y < used[x].size() && used[x][y]) y++;
+            if (used[x].size() <= y) used[x].resize(y + 1, false);
+            used[x][y] = true;
+            pos[i] = {x, y};
+        }
+        return pos;
+    };
 
-    // 縦方向の座標を雑に決める
-    std::vector<int> Y(N);
-    for (int i = 0; i < N; i++) {
-        auto [id, x] = Ord[i];
-        int y = s.pos[i].second;
-        Y[id] = y;
-    }
+    // 答えを作成
+    auto make_ans = [&](const std::vector<std::pair<int, int>> &pos) {
+        std::vector<std::tuple<std::string, int, int>> P(N);
+        for (int i = 0; i < N; i++) {
+            P[i] = {mp.get_process(i), pos[i].first, pos[i].second};
+        }
+        return P;
+    };
+
+    // 下界に達するか, time_end / 2 の間改善しなければ打ち切る
+    const int time_end = 2000;
+    SearchControl control;
+    control.lower_bound = calc_lower_bound(ctx);
+    control.gap = 0;
+    control.stagnation_ms = time_end / 2;
+    search_control = &control;
+
+    // 一定間隔でそれまでの最良解を出力し, そのスコアを報告する
+    const int report_interval = 500;
+    auto report = [&](const std::vector<MyState::Update> &U, const MyState::Score &) {
+        auto pos = make_pos(U);
+        search_report(calc_score(pos, E));
+        CheckLib::write_csv_atomic(path_out, make_ans(pos));
+    };
 
-    std::vector<std::pair<int, int>> pos(N);
-    for (int i = 0; i < N; i++) {
-        pos[i] = {X[i], Y[i]};
-    }
+    MyState s;
+    auto U = beam_search<timer<0>, MyState, MyCmp>()(s, 50, time_end, report_interval, report);
+    auto pos = make_pos(U);
 
     // スコア計算
-    double score = calc_score(pos, E);
+    auto metrics = evaluate_layout_parallel(pos, E, LayoutMetrics::required<ScorePolicyDefault>() | LayoutMetrics::Cross | LayoutMetrics::BadPenetration);
+    double score = metrics.score<ScorePolicyDefault>();
     std::cout << "score is " << score << '\n';
-    std::cout << "lensum is " << sum_edge_length(pos, E) << '\n';
-    std::cout << "cross is " << count_edge_cross(pos, E) << '\n';
-    std::cout << "penetration is " << count_bad_penetration(pos, E) << '\n';
-    
+    std::cout << "gap is " << calc_gap(score, control.lower_bound) << '\n';
+    std::cout << "lensum is " << metrics.length << '\n';
+    std::cout << "cross is " << metrics.cross << '\n';
+    std::cout << "penetration is " << metrics.bad_penetration << '\n';
 
-    // 答えを作成
-    std::vector<std::tuple<std::string, int, int>> P(N);
-    for (int i = 0; i < N; i++) {
-        P[i] = {mp.get_process(i), pos[i].first, pos[i].second};
-    }
-    CheckLib::write_csv(path_out, P);
+    CheckLib::write_csv_atomic(path_out, make_ans(pos));
 }
\ No newline at end of file
@@ -4,7 +4,10 @@
 #include <memory>
 #include <cassert>
 #include <algorithm>
+#include "SearchControl.hpp"
+#include "TaskPool.hpp"
 
+// Stateはデフォルト構築でき, update(u)は状態を変えずに遷移先を返すこと (複数のスレッドから同時に呼ばれる)
 template<typename Timer, typename State, typename Cmp>
 struct beam_search {
     using Score = typename State::Score;
@@ -19,24 +22,54 @@ struct beam_search {
     using psp = std::pair<State, ptr>;
     struct _Cmp{ bool operator ()(const psp &A, const psp &B){return Cmp()(A.first.score, B.first.score);} };
 
+    // 途中経過を受け取らない場合のコールバック
+    struct no_report {
+        void operator ()(const std::vector<Update> &, const Score &) {}
+    };
+
+    // ノードvまでの操作列を復元
+    static std::vector<Update> restore(ptr v) {
+        std::vector<Update> res;
+        while (v) {
+            res.push_back(v->u);
+            v = v->p;
+        }
+        std::reverse(res.begin(), res.end());
+        return res;
+    }
+
     std::vector<Update> operator ()(State s, int Width, int TimeEnd) {
+        return (*this)(s, Width, TimeEnd, 0, no_report());
+    }
+
+    // ReportInterval := この間隔(ms)ごとに report(それまでのbestの操作列, bestのスコア) を呼ぶ, 0以下なら呼ばない
+    template<typename Report>
+    std::vector<Update> operator ()(State s, int Width, int TimeEnd, int ReportInterval, Report report) {
         Timer::set();
         std::vector<psp> Snow;
         Snow.push_back({s, ptr(nullptr)});
         psp best{s, ptr(nullptr)};
+        long long TimeReport = ReportInterval;
 
         while (true) {
             long long te = Timer::elapse();
+            if (ReportInterval > 0 && te >= TimeReport) {
+                report(restore(best.second), best.first.score);
+                TimeReport = te + ReportInterval;
+            }
             if (te * 1.1 > TimeEnd) Width = 1; // 時間がない場合幅を1にする
-            if (te > TimeEnd) break;
-            std::vector<psp> Snext;
+            if (te > TimeEnd || search_stop_requested()) break;
+            // 遷移の列挙は乱数を使うので順に行い, 遷移先の計算(update)だけTaskPoolで並列に行う
+            // 結果は列挙した順に置くので, スレッド数によらず同じ探索になる
+            std::vector<std::pair<int, Update>> jobs;
             for (int i = 0; i < std::min(Width, (int)Snow.size()); i++) {
-                auto [s_now, v] = Snow[i];
-                for (Update u : s_now.get_neighbors()) {
-                    State s_next = s_now.update(u);
-                    Snext.push_back({s_next, ptr(new node(v, u))});
-                }
+                for (Update u : Snow[i].first.get_neighbors()) jobs.push_back({i, u});
             }
+            std::vector<psp> Snext(jobs.size());
+            TaskPool::parallel_for(jobs.size(), [&](int j) {
+                auto [i, u] = jobs[j];
+                Snext[j] = {Snow[i].first.update(u), ptr(new node(Snow[i].second, u))};
+            }, 8);
             std::swap(Snow, Snext);
             if (Snow.empty()) break;
             std::sort(Snow.begin(), Snow.end(), _Cmp());
@@ -46,14 +79,7 @@ struct beam_search {
             //if(Snow[0].first.is_done()) break;
         }
         // bestの操作列の復元
-        std::vector<Update> res;
-        ptr v = best.second;
-        while (v) {
-            res.push_back(v->u);
-            v = v->p;
-        }
-        std::reverse(res.begin(), res.end());
-        return res;
+        return restore(best.second);
     }
 };
 #endif
\ No newline at end of file
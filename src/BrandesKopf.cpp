@@ -0,0 +1,44 @@
+#include "CheckLib.hpp"
+#include "Lib.hpp"
+#include "Engine.hpp"
+#include "ParallelScore.hpp"
+
+// Brandes-Köpfによる縦軸の座標の決定
+// 横軸はネットワーク単体法, 列の中の並び順は交差削減で決め, 辺がなるべくまっすぐになるように縦軸を決める
+// 山登り法の初期解にも使える (Engine.hppのsolve_brandes_kopf_climbing)
+int main() {
+    std::string path_in = "../testcase/case1.csv";
+    std::string path_out = "../testcase/case1_bk.csv";
+    assert(CheckLib::is_valid_input(path_in));
+    std::vector<std::pair<int, int>> E;
+    ProcessMap mp;
+    for (auto [s, t] : CheckLib::read_csv(path_in)) {
+        int sid = mp.register_process(s);
+        int tid = mp.register_process(t);
+        E.push_back({sid, tid});
+    }
+
+    E = remove_multiple_edge(E);
+    renumber(mp, E);
+    int N = mp.size();
+    ProblemContext ctx(N, E);
+    auto pos = solve_brandes_kopf(ctx);
+
+    // スコア計算
+    auto metrics = evaluate_layout_parallel(pos, E, LayoutMetrics::required<ScorePolicyDefault>() | LayoutMetrics::Cross | LayoutMetrics::BadPenetration);
+    double score = metrics.score<ScorePolicyDefault>();
+    std::cout << "score is " << score << '\n';
+    std::cout << "lensum is " << metrics.length << '\n';
+    std::cout << "cross is " << metrics.cross << '\n';
+    std::cout << "penetration is " << metrics.bad_penetration << '\n';
+    // 比較のため同じ入力でのGreedy1(gr)のスコア
+    std::cout << "score of gr is " << calc_score_parallel(solve_greedy(ctx), E) << '\n';
+
+
+    // 答えを作成
+    std::vector<std::tuple<std::string, int, int>> P(N);
+    for (int i = 0; i < N; i++) {
+        P[i] = {mp.get_process(i), pos[i].first, pos[i].second};
+    }
+    CheckLib::write_csv(path_out, P);
+}
\ No newline at end of file
@@ -0,0 +1,182 @@
+#ifndef _BRANDES_KOPF_H_
+#define _BRANDES_KOPF_H_
+#include "Lib.hpp"
+#include "ProblemContext.hpp"
+#include "Layered.hpp"
+#include "NetworkSimplex.hpp"
+#include <limits>
+
+/*
+列の中の並び順を保ったまま縦軸の座標を決める (Brandes-Köpfの座標割り当て)
+1. 2列以上またぐ辺の途中のダミー頂点どうしの辺(内側の辺)と交差する辺には印を付ける (type 1 conflict)
+2. 列を前から/後ろから, 列の中を上から/下からたどる4通りについて,
+   各頂点を隣の列の隣接頂点の中央値の頂点と, 交差しないように揃えてブロックにする (vertical alignment)
+   ブロックを並び順を保って上に詰める (horizontal compaction, ブロックのグラフの最長路)
+3. 4通りを幅が最小のものに合わせてずらし, 各頂点で4つの値の中央の2つの平均を取る (balancing)
+4. 整数に丸め, 列の中で並び順どおりに1以上離れるように直す
+揃えた辺は横にまっすぐになり, ダミー頂点の位置には工程が置かれないので, 長い辺も貫通しにくい
+O(V + M) (Vはダミー頂点を含む頂点数, Mはダミー頂点を含む辺数)
+返り値 : ダミー頂点を含む各頂点のy座標 (最小は0)
+*/
+std::vector<int> brandes_kopf_y(const LayeredGraph &LG) {
+    int V = LG.V, L = LG.layer.size();
+    auto dummy = [&](int v) { return v >= LG.N; };
+
+    // 1. 印を付けた辺 (前の列の頂点) * V + (次の列の頂点)
+    std::vector<long long> marked;
+    for (int x = 1; x + 1 < L; x++) {
+        const auto &up = LG.layer[x], &lo = LG.layer[x + 1];
+        int k0 = 0, l = 0;
+        for (int l1 = 0; l1 < lo.size(); l1++) {
+            int v = lo[l1];
+            int inner = -1; // vが内側の辺の端点ならその前の列の頂点
+            if (dummy(v)) {
+                for (int u : LG.prv[v]) {
+                    if (dummy(u)) inner = u;
+                }
+            }
+            if (l1 + 1 == lo.size() || inner != -1) {
+                int k1 = (inner != -1 ? LG.Y[inner] : (int)up.size() - 1);
+                for (; l <= l1; l++) {
+                    for (int u : LG.prv[lo[l]]) {
+                        if (LG.Y[u] < k0 || LG.Y[u] > k1) marked.push_back((long long)u * V + lo[l]);
+                    }
+                }
+                k0 = k1;
+            }
+        }
+    }
+    std::sort(marked.begin(), marked.end());
+    auto is_marked = [&](int u, int v) {
+        if (LG.X[u] > LG.X[v]) std::swap(u, v);
+        return std::binary_search(marked.begin(), marked.end(), (long long)u * V + v);
+    };
+
+    // 2. vflip := 列を後ろからたどる, hflip := 列の中を下からたどる
+    std::vector<std::vector<int>> ys;
+    for (int vflip = 0; vflip < 2; vflip++) {
+        for (int hflip = 0; hflip < 2; hflip++) {
+            std::vector<int> pos(V);
+            auto layer_at = [&](int i) -> std::vector<int> {
+                auto res = LG.layer[vflip ? L - 1 - i : i];
+                if (hflip) std::reverse(res.begin(), res.end());
+                return res;
+            };
+            std::vector<std::vector<int>> lay(L);
+            for (int i = 0; i < L; i++) {
+                lay[i] = layer_at(i);
+                for (int k = 0; k < lay[i].size(); k++) pos[lay[i][k]] = k;
+            }
+            const auto &upper = (vflip ? LG.nxt : LG.prv);
+
+            // vertical alignment
+            std::vector<int> root(V), align(V);
+            std::iota(root.begin(), root.end(), 0);
+            std::iota(align.begin(), align.end(), 0);
+            std::vector<int> U;
+            for (int i = 1; i < L; i++) {
+                int r = -1;
+                for (int v : lay[i]) {
+                    U = upper[v];
+                    int d = U.size();
+                    if (d == 0) continue;
+                    std::sort(U.begin(), U.end(), [&](int a, int b) { return pos[a] < pos[b]; });
+                    for (int m : {(d - 1) / 2, d / 2}) {
+                        if (align[v] != v) break;
+                        int u = U[m];
+                        if (!is_marked(u, v) && r < pos[u]) {
+                            align[u] = v;
+                            root[v] = root[u];
+                            align[v] = root[v];
+                            r = pos[u];
+                        }
+                    }
+                }
+            }
+
+            // horizontal compaction: 列の中で隣り合う頂点のブロックの間に 1 以上の差を付ける最長路
+            std::vector<std::vector<int>> g(V);
+            std::vector<int> indeg(V, 0);
+            for (int i = 0; i < L; i++) {
+                for (int k = 1; k < lay[i].size(); k++) {
+                    g[root[lay[i][k - 1]]].push_back(root[lay[i][k]]);
+                    indeg[root[lay[i][k]]]++;
+                }
+            }
+            std::vector<int> y(V, 0), que;
+            for (int v = 0; v < V; v++) {
+                if (root[v] == v && indeg[v] == 0) que.push_back(v);
+            }
+            for (int h = 0; h < que.size(); h++) {
+                int b = que[h];
+                for (int c : g[b]) {
+                    y[c] = std::max(y[c], y[b] + 1);
+                    if (--indeg[c] == 0) que.push_back(c);
+                }
+            }
+            for (int v = 0; v < V; v++) y[v] = (hflip ? -1 : 1) * y[root[v]];
+            ys.push_back(y);
+        }
+    }
+
+    // 3. 幅が最小のものに合わせる. 上から詰めたものは最小値を, 下から詰めたものは最大値を揃える
+    std::vector<int> mn(4), mx(4);
+    int best = 0;
+    for (int j = 0; j < 4; j++) {
+        mn[j] = *std::min_element(ys[j].begin(), ys[j].end());
+        mx[j] = *std::max_element(ys[j].begin(), ys[j].end());
+        if (mx[j] - mn[j] < mx[best] - mn[best]) best = j;
+    }
+    for (int j = 0; j < 4; j++) {
+        int d = (j % 2 == 0 ? mn[best] - mn[j] : mx[best] - mx[j]);
+        for (int &y : ys[j]) y += d;
+    }
+    std::vector<int> Y(V);
+    for (int v = 0; v < V; v++) {
+        int a[4] = {ys[0][v], ys[1][v], ys[2][v], ys[3][v]};
+        std::sort(a, a + 4);
+        Y[v] = (int)std::floor((a[1] + a[2]) / 2.0);
+    }
+
+    // 4. 列の中で並び順どおりに1以上離す
+    int low = std::numeric_limits<int>::max();
+    for (int x = 0; x < L; x++) {
+        for (int k = 1; k < LG.layer[x].size(); k++) {
+            int u = LG.layer[x][k - 1], v = LG.layer[x][k];
+            Y[v] = std::max(Y[v], Y[u] + 1);
+        }
+        if (!LG.layer[x].empty()) low = std::min(low, Y[LG.layer[x][0]]);
+    }
+    for (int &y : Y) y -= low;
+    return Y;
+}
+
+// 横軸はネットワーク単体法, 列の中の並び順は交差削減, 縦軸はBrandes-Köpfで決める
+// Brandes-Köpfの座標はダミー頂点の行を含むので, 工程の行だけを残して詰める
+// 辺が密だと揃えるための段差で縦に長くなりスコアが悪くなるので, 交差削減の順に各列で上から詰めた配置とスコアを比べて良い方を返す
+// time_end := 制限時間(ms), 負なら制限しない. ネットワーク単体法に半分までを使い, 残りを交差削減に使う
+template<typename Policy = ScorePolicyDefault>
+std::vector<std::pair<int, int>> solve_brandes_kopf(const ProblemContext &ctx, int time_end = -1) {
+    int N = ctx.size();
+    long long start = timems();
+    auto X = network_simplex_x(ctx, time_end < 0 ? -1 : time_end / 2);
+    LayeredGraph LG(N, ctx.edges(), X);
+    order_layers(LG, 24, false, time_end < 0 ? -1 : std::max<long long>(0, time_end - (timems() - start)));
+    auto Y = brandes_kopf_y(LG);
+    // ダミー頂点だけの行を除く (工程のy座標を座標圧縮する). 同じ行の工程は同じ行のまま, 列の中の順序も変わらない
+    std::vector<int> rows(Y.begin(), Y.begin() + N);
+    std::sort(rows.begin(), rows.end());
+    rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+    std::vector<std::pair<int, int>> pos(N), stacked(N);
+    for (int i = 0; i < N; i++) pos[i] = {X[i], int(std::lower_bound(rows.begin(), rows.end(), Y[i]) - rows.begin())};
+    for (const auto &L : LG.layer) {
+        int y = 0;
+        for (int v : L) {
+            if (v < N) stacked[v] = {X[v], y++};
+        }
+    }
+    ScoreWorkspace ws;
+    if (calc_score<Policy>(stacked, ctx.edges(), ws) < calc_score<Policy>(pos, ctx.edges(), ws)) return stacked;
+    return pos;
+}
+#endif
@@ -1,18 +1,6 @@
 #include "CheckLib.hpp"
 #include "Lib.hpp"
-
-// 文字列sをdelimで分割
-std::vector<std::string> split(const std::string &s, char delim) {
-    std::vector<std::string> elems;
-    std::stringstream ss(s);
-    std::string item;
-    while (std::getline(ss, item, delim)) {
-        if (!item.empty()) {
-            elems.push_back(item);
-        }
-    }
-    return elems;
-}
+#include "ParallelScore.hpp"
 
 // サンプルのスコア計算用
 int main() {
@@ -30,20 +18,17 @@ int main() {
     std::vector<std::pair<int, int>> pos(N);
 
     // 位置を読み込む
-    std::ifstream ifs(path_out, std::ios::in);
-    std::string s;
-    while (std::getline(ifs, s)) {
-        if (!s.empty()) {
-            auto e = split(s, ',');
-            int id = mp.get_id(e[0]);
-            pos[id].first = std::stoi(e[1]);
-            pos[id].second = std::stoi(e[2]);
-        }
+    for (auto [name, x, y] : CheckLib::read_layout(path_out)) {
+        int id = mp.get_id(name);
+        pos[id].first = x;
+        pos[id].second = y;
     }
-    double score = calc_score(pos, E);
+    // スコア計算
+    auto metrics = evaluate_layout_parallel(pos, E, LayoutMetrics::required<ScorePolicyDefault>() | LayoutMetrics::Cross | LayoutMetrics::BadPenetration);
+    double score = metrics.score<ScorePolicyDefault>();
     std::cout << "score is " << score << '\n';
-    std::cout << "lensum is " << sum_edge_length(pos, E) << '\n';
-    std::cout << "cross is " << count_edge_cross(pos, E) << '\n';
-    std::cout << "penetration is " << count_bad_penetration(pos, E) << '\n';
+    std::cout << "lensum is " << metrics.length << '\n';
+    std::cout << "cross is " << metrics.cross << '\n';
+    std::cout << "penetration is " << metrics.bad_penetration << '\n';
 
 }
\ No newline at end of file
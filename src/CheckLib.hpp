@@ -10,6 +10,7 @@
 #include <map>
 #include <algorithm>
 #include <queue>
+#include "Lib.hpp"
 
 // 指定したパスが正しい入力(工程の前後関係のCSVファイル)か判定する関数群
 namespace CheckLib {
@@ -84,6 +85,34 @@ namespace CheckLib {
         return E;
     }
 
+    // 文字列sをdelimで分割
+    std::vector<std::string> split(const std::string &s, char delim) {
+        std::vector<std::string> elems;
+        std::stringstream ss(s);
+        std::string item;
+        while (std::getline(ss, item, delim)) {
+            if (!item.empty()) {
+                elems.push_back(item);
+            }
+        }
+        return elems;
+    }
+
+    // write_csvで出力した配置((工程名),(x座標),(y座標)の各行)を読み込む
+    std::vector<std::tuple<std::string, int, int>> read_layout(const std::string &path) {
+        std::ifstream ifs(path, std::ios::in);
+        std::string s;
+        std::vector<std::tuple<std::string, int, int>> P;
+        while (std::getline(ifs, s)) {
+            remove_suffix_endl(s);
+            if (!s.empty()) {
+                auto e = split(s, ',');
+                P.push_back({e[0], std::stoi(e[1]), std::stoi(e[2])});
+            }
+        }
+        return P;
+    }
+
     // path_outに出力
     void write_csv(const std::string &path, const std::vector<std::tuple<std::string, int, int>> &P) {
         std::ofstream ofs(path);
@@ -93,65 +122,34 @@ namespace CheckLib {
         ofs.close();
     }
 
+    // path_outに出力
+    // 一時ファイルに書いてから置き換えるので, 途中で強制終了されても壊れたファイルが残らない
+    void write_csv_atomic(const std::string &path, const std::vector<std::tuple<std::string, int, int>> &P) {
+        std::string path_tmp = path + ".tmp";
+        write_csv(path_tmp, P);
+        std::filesystem::rename(path_tmp, path);
+    }
+
     // DAG(閉路の無いグラフ)か
-    // トポロジカルソートを実行できることとDAGなことが同値であるため、トポロジカルソートを行って判定
-    bool is_DAG(const std::vector<std::vector<int>> &G) {
-        int N = G.size();
-        std::vector<int> in(N, 0);
-        for (int s = 0; s < N; s++) {
-            for (int t : G[s]) {
-                in[t]++;
-            }
-        }
-        std::queue<int> que;
-        for (int i = 0; i < N; i++) {
-            if (in[i] == 0) {
-                que.push(i);
-            }
-        }
-        // 入次数が0の頂点が現れるたびにその頂点及び接続する辺を消す
-        int cnt = 0;
-        while (!que.empty()) {
-            int s = que.front();
-            que.pop();
-            cnt++;
-            for (int t : G[s]) {
-                in[t]--;
-                if (in[t] == 0) {
-                    que.push(t);
-                }
-            }
-        }
-        return cnt == N;
+    // トポロジカルソートを実行できることとDAGなことが同値であるため、トポロジカルソート(topological_order)を行って判定
+    // Graph := 隣接リスト(std::vector<std::vector<int>>) または CSRGraph
+    template<typename Graph>
+    bool is_DAG(const Graph &G) {
+        return topological_order(G).size() == G.size();
     }
 
     // is_valid_formatを満たすとして
     // pathがDAGか判定
     bool is_DAG(const std::string &path) {
         auto E = read_csv(path);
-        std::map<std::string, int> mp;
-        std::vector<std::vector<int>> G;
+        ProcessMap mp;
+        std::vector<std::pair<int, int>> F;
         for (auto [a, b] : E) {
-            int A, B;
-            if (mp.find(a) == mp.end()) {
-                int sz = mp.size();
-                mp.emplace(a, sz);
-                A = sz;
-            } else {
-                A = mp.at(a);
-            }
-            if (mp.find(b) == mp.end()) {
-                int sz = mp.size();
-                mp.emplace(b, sz);
-                B = sz;
-            } else {
-                B = mp.at(b);
-            }
-            if (G.size() < mp.size()) {
-                G.resize(mp.size());
-            }
-            G[A].push_back(B);
+            int A = mp.register_process(a);
+            int B = mp.register_process(b);
+            F.push_back({A, B});
         }
+        CSRGraph G(mp.size(), F);
         return is_DAG(G);
     }
 
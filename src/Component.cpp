@@ -0,0 +1,51 @@
+#include "CheckLib.hpp"
+#include "Lib.hpp"
+#include "Engine.hpp"
+#include "Component.hpp"
+#include "ParallelScore.hpp"
+
+// 弱連結成分ごとに並列に配置して縦に並べる
+int main() {
+    std::string path_in = "../testcase/case1.csv";
+    std::string path_out = "../testcase/case1_co.csv";
+    std::string engine = "perm"; // 各成分に使う手法 (Engine.hppのsolveを参照)
+    int time_end = 2000;
+    bool reduce = false; // 推移簡約した辺集合で最適化するか (スコアは元の辺集合で計算する)
+
+    assert(CheckLib::is_valid_input(path_in));
+    assert(is_engine(engine));
+    std::vector<std::pair<int, int>> E;
+    ProcessMap mp;
+    for (auto [s, t] : CheckLib::read_csv(path_in)) {
+        int sid = mp.register_process(s);
+        int tid = mp.register_process(t);
+        E.push_back({sid, tid});
+    }
+    E = remove_multiple_edge(E);
+    renumber(mp, E);
+    int N = mp.size();
+    std::cout << "component is " << decompose_component(N, E).size() << '\n';
+    if (reduce) {
+        std::cout << "edge is " << E.size() << " -> " << transitive_reduction(N, E).size() << '\n';
+    }
+
+    auto solver = [&](int n, const std::vector<std::pair<int, int>> &e, int t) {
+        if (reduce) return solve(engine, n, transitive_reduction(n, e), t);
+        return solve(engine, n, e, t);
+    };
+    auto pos = solve_by_component(N, E, time_end, solver);
+
+    // スコア計算
+    auto metrics = evaluate_layout_parallel(pos, E, LayoutMetrics::required<ScorePolicyDefault>() | LayoutMetrics::Cross | LayoutMetrics::BadPenetration);
+    double score = metrics.score<ScorePolicyDefault>();
+    std::cout << "score is " << score << '\n';
+    std::cout << "lensum is " << metrics.length << '\n';
+    std::cout << "cross is " << metrics.cross << '\n';
+    std::cout << "penetration is " << metrics.bad_penetration << '\n';
+
+    std::vector<std::tuple<std::string, int, int>> ans(N);
+    for (int i = 0; i < N; i++) {
+        ans[i] = {mp.get_process(i), pos[i].first, pos[i].second};
+    }
+    CheckLib::write_csv(path_out, ans);
+}
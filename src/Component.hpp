@@ -0,0 +1,105 @@
+#ifndef _COMPONENT_H_
+#define _COMPONENT_H_
+#include "Lib.hpp"
+#include "TaskPool.hpp"
+#include <algorithm>
+#include <numeric>
+
+// 互いに辺で繋がっていない工程群は独立に配置できる
+// 弱連結成分ごとに配置して最後に縦に並べる
+
+// 弱連結成分
+struct Component {
+    std::vector<int> id; // 成分内の番号 -> 元の番号
+    std::vector<std::pair<int, int>> E; // 成分内の番号で表した辺集合
+};
+
+// 弱連結成分に分解する. 成分は大きい順に並ぶ
+// O(N + M α(N))
+std::vector<Component> decompose_component(int N, const std::vector<std::pair<int, int>> &E) {
+    std::vector<int> par(N);
+    std::iota(par.begin(), par.end(), 0);
+    auto find = [&](int v) {
+        while (par[v] != v) {
+            par[v] = par[par[v]];
+            v = par[v];
+        }
+        return v;
+    };
+    for (auto [s, t] : E) {
+        int a = find(s), b = find(t);
+        if (a != b) par[a] = b;
+    }
+    // 根 -> 成分の番号
+    std::vector<int> cid(N, -1), local(N);
+    std::vector<Component> ans;
+    for (int i = 0; i < N; i++) {
+        int r = find(i);
+        if (cid[r] == -1) {
+            cid[r] = ans.size();
+            ans.push_back({});
+        }
+        local[i] = ans[cid[r]].id.size();
+        ans[cid[r]].id.push_back(i);
+    }
+    for (auto [s, t] : E) {
+        ans[cid[find(s)]].E.push_back({local[s], local[t]});
+    }
+    std::stable_sort(ans.begin(), ans.end(), [](const Component &a, const Component &b) { return a.id.size() > b.id.size(); });
+    return ans;
+}
+
+/*
+各成分の配置を1つの配置にまとめる
+compress_yと同様に, 各列の使用済みの高さを持っておき
+成分の占める列の範囲でその高さの最大値の位置に成分を置く
+x座標の範囲が重ならない成分同士は同じ高さに並ぶ
+*/
+std::vector<std::pair<int, int>> pack_component(int N, const std::vector<Component> &C, const std::vector<std::vector<std::pair<int, int>>> &layout) {
+    std::vector<std::pair<int, int>> ans(N);
+    std::vector<int> top; // top[x] := 列xで次に使える高さ
+    for (int c = 0; c < C.size(); c++) {
+        const auto &pos = layout[c];
+        int lx = std::numeric_limits<int>::max(), rx = std::numeric_limits<int>::min();
+        int ly = std::numeric_limits<int>::max(), ry = std::numeric_limits<int>::min();
+        for (auto [x, y] : pos) {
+            lx = std::min(lx, x);
+            rx = std::max(rx, x);
+            ly = std::min(ly, y);
+            ry = std::max(ry, y);
+        }
+        if (pos.empty()) continue;
+        if (rx >= top.size()) top.resize(rx + 1, 0);
+        int y0 = 0;
+        for (int x = lx; x <= rx; x++) y0 = std::max(y0, top[x]);
+        for (int x = lx; x <= rx; x++) top[x] = y0 + (ry - ly + 1);
+        for (int i = 0; i < C[c].id.size(); i++) {
+            ans[C[c].id[i]] = {pos[i].first, pos[i].second - ly + y0};
+        }
+    }
+    return ans;
+}
+
+/*
+成分ごとに solver(工程数, 辺集合, 制限時間(ms)) -> 配置 をTaskPoolのタスクとして並列に呼んで1つの配置にまとめる
+制限時間は成分の工程数に比例して配分する (全体でおよそtime_endに収まる)
+*/
+template<typename Solver>
+std::vector<std::pair<int, int>> solve_by_component(int N, const std::vector<std::pair<int, int>> &E, int time_end, Solver solver) {
+    auto C = decompose_component(N, E);
+    int K = C.size();
+    int threads = std::min(TaskPool::size(), K);
+    std::vector<std::vector<std::pair<int, int>>> layout(K);
+    // 大きい成分から順に積むので, 空いたワーカーが大きい成分から取っていく
+    TaskPool::TaskGroup g;
+    for (int c = 0; c < K; c++) {
+        g.run([&, c]() {
+            int n = C[c].id.size();
+            int t = std::max(1, (int)std::min<long long>(time_end, (long long)time_end * threads * n / N));
+            layout[c] = solver(n, C[c].E, t);
+        });
+    }
+    g.wait();
+    return pack_component(N, C, layout);
+}
+#endif
@@ -0,0 +1,276 @@
+#ifndef _ENGINE_H_
+#define _ENGINE_H_
+#include "Lib.hpp"
+#include "Random.hpp"
+#include "SimulatedAnnealing.hpp"
+#include "StateSA.hpp"
+#include "Multilevel.hpp"
+#include "Layered.hpp"
+#include "ScoreCache.hpp"
+#include "PermEvaluator.hpp"
+#include "ApproxScore.hpp"
+#include "NetworkSimplex.hpp"
+#include "BrandesKopf.hpp"
+#include "Motif.hpp"
+#include "SearchControl.hpp"
+#include "ProblemContext.hpp"
+#include <string>
+#include <numeric>
+#include <limits>
+#include <memory>
+
+// 各手法を (問題の文脈, 制限時間(ms)) -> 配置 の関数として呼べるようにしたもの
+// 文脈(ProblemContext)は多重辺を除いた辺集合から作る. 列やパスへの分解は文脈が1回だけ計算して手法の間で共有する
+// 状態(タイマー, 乱数)はスレッドごとに持つので別スレッドから同時に呼んでもよい
+// スコアを使う手法はテンプレート引数でcalc_scoreの重み(Policy)を指定できる
+
+// 横軸はX, 縦軸は各列で番号順に上から詰める
+std::vector<std::pair<int, int>> stack_columns(const std::vector<int> &X) {
+    int N = X.size();
+    std::vector<int> Y(N), xcnt(N, 0);
+    for (int i = 0; i < N; i++) {
+        int x = X[i];
+        Y[i] = xcnt[x];
+        xcnt[x]++;
+    }
+    std::vector<std::pair<int, int>> pos(N);
+    for (int i = 0; i < N; i++) {
+        pos[i] = {X[i], Y[i]};
+    }
+    return pos;
+}
+
+// 横軸はcalc_min_x, 縦軸は各列で上から詰める (Greedy1)
+std::vector<std::pair<int, int>> solve_greedy(const ProblemContext &ctx) {
+    return stack_columns(ctx.min_x());
+}
+
+// 横軸はネットワーク単体法で辺の横方向の長さの和を最小にし, 縦軸は各列で上から詰める
+// time_end := 制限時間(ms), 負なら最適解に達するまで
+std::vector<std::pair<int, int>> solve_network_simplex(const ProblemContext &ctx, int time_end = -1) {
+    return stack_columns(network_simplex_x(ctx, time_end));
+}
+
+// パスに分解してパスの並び順を探索する (Greedy2)
+// パスが6本以下なら全探索, そうでなければ時間の許す限りランダムな順列を試す
+// 順列はblock個ずつまとめてPermEvaluatorで並列に評価する
+template<typename Policy = ScorePolicyDefault>
+std::vector<std::pair<int, int>> solve_perm(const ProblemContext &ctx, int time_end, int block = 256) {
+    const auto &X = ctx.min_x();
+    const auto &P = ctx.long_paths();
+    const auto &E = ctx.edges();
+    int K = P.size();
+    PermEvaluator<Policy> eval(P, X, E);
+    if (K <= 6) {
+        std::vector<std::vector<int>> perms;
+        std::vector<int> perm(K);
+        std::iota(perm.begin(), perm.end(), 0);
+        do {
+            perms.push_back(perm);
+        } while (std::next_permutation(perm.begin(), perm.end()));
+        auto [score, best] = eval(perms);
+        search_report(score[best]);
+        return compress_y(P, perms[best], X);
+    } else {
+        double min_score = std::numeric_limits<double>::max();
+        std::vector<int> min_perm(K);
+        std::iota(min_perm.begin(), min_perm.end(), 0);
+        // パスが少ないと同じ順列を何度も引くので評価済みの順列は再計算しない
+        ScoreCache<double> cache;
+        timer<0>::set();
+        while (timer<0>::elapse() <= time_end && !search_stop_requested()) {
+            std::vector<std::vector<int>> perms(block), todo;
+            std::vector<double> score(block);
+            std::vector<int> miss;
+            for (int i = 0; i < block; i++) {
+                perms[i] = rng.random_permutation(K);
+                if (!cache.find(Zobrist::perm_key(perms[i]), score[i])) {
+                    miss.push_back(i);
+                    todo.push_back(perms[i]);
+                }
+            }
+            auto todo_score = eval(todo).first;
+            for (int j = 0; j < miss.size(); j++) {
+                score[miss[j]] = todo_score[j];
+                cache.insert(Zobrist::perm_key(perms[miss[j]]), todo_score[j]);
+            }
+            for (int i = 0; i < block; i++) {
+                if (score[i] < min_score) {
+                    min_score = score[i];
+                    min_perm = perms[i];
+                    search_report(min_score);
+                }
+            }
+        }
+        return compress_y(P, min_perm, X);
+    }
+}
+
+// パスの並び順とx座標を焼きなます (LongPath)
+// replicas := 独立に焼きなます状態の数, 0ならTaskPoolのワーカー数. 最良のものを返す
+// 初期化と温度の調整(制限時間の1/10まで)にかかった時間は制限時間から引く
+template<typename Policy = ScorePolicyDefault>
+std::vector<std::pair<int, int>> solve_long_path(const ProblemContext &ctx, int time_end, int replicas = 0) {
+    long long start = timems();
+    StateSA<Policy> sa(ctx);
+    auto [T0, T1] = calibrate_temperature(sa, 1000, 0.5, 0.001, time_end / 10);
+    if (replicas <= 0) replicas = TaskPool::size();
+    std::vector<StateSA<Policy>> vs(replicas, sa);
+    int rest = std::max<long long>(0, time_end - (timems() - start));
+    int best = simulated_annealing_replicas<timer<0>, temperature_scheduler_reheat<0>, StateSA<Policy>>(vs, T0, T1, rest, 1);
+    return vs[best].best_pos();
+}
+
+// 同じ列の2つの工程を入れ替える山登り法 (climbing)
+// initの配置から始める
+// sample > 0 なら受理の判定にはsample本の辺から推定したスコアの変化(ApproxScore)を使い,
+// 変化の信頼区間が全て改善側にある入れ替えだけを受理する
+// resync回試すごとに厳密なスコアを計算する. 厳密なスコアが最良の配置より悪ければ最良の配置に戻し, 標本を取り直す
+template<typename Policy = ScorePolicyDefault>
+std::vector<std::pair<int, int>> solve_climbing(int N, const std::vector<std::pair<int, int>> &E, int time_end, const std::vector<std::pair<int, int>> &init, int sample = 0, int resync = 1000) {
+    std::vector<int> X(N), Y(N);
+    std::vector<std::vector<int>> Col(N);
+    for (int i = 0; i < N; i++) {
+        X[i] = init[i].first;
+        Y[i] = init[i].second;
+        Col[X[i]].push_back(i);
+    }
+
+    std::vector<std::pair<int, int>> pos(N);
+    ScoreWorkspace ws;
+    auto _calc_score = [&]() -> double {
+        for (int i = 0; i < N; i++) {
+            pos[i] = {X[i], Y[i]};
+        }
+        return calc_score<Policy>(pos, E, ws);
+    };
+
+    double score = _calc_score();
+    double best_score = score;
+    auto best_Y = Y;
+    search_report(best_score);
+    // 標本を取ると乱数列が進むので, 推定を使わない場合は作らない
+    std::unique_ptr<ApproxScore<Policy>> approx;
+    if (sample > 0) {
+        approx = std::make_unique<ApproxScore<Policy>>(N, E, X, sample);
+        approx->reset(pos);
+    }
+    auto _resync = [&]() {
+        double exact = _calc_score();
+        if (exact < best_score) {
+            best_score = exact;
+            best_Y = Y;
+            search_report(best_score);
+        } else {
+            Y = best_Y;
+            for (int i = 0; i < N; i++) {
+                pos[i] = {X[i], Y[i]};
+            }
+        }
+        approx->resample();
+        approx->reset(pos);
+    };
+
+    timer<0>::set();
+    long long iter = 0;
+    while (true) {
+        if (timer<0>::elapse() >= time_end || search_stop_requested()) break;
+        int x = rng.random_number() % N;
+        int sz = Col[x].size();
+        if (sz <= 1) continue;
+        if (sample > 0 && ++iter % resync == 0) _resync();
+        int a = Col[x][rng.random_number() % sz];
+        int b = Col[x][rng.random_number() % sz];
+        std::swap(Y[a], Y[b]);
+        if (sample > 0) {
+            auto diff = approx->swap(a, b);
+            if (diff.score + diff.bound >= 0) {
+                approx->swap(a, b);
+                std::swap(Y[a], Y[b]);
+            }
+            continue;
+        }
+        double new_score = _calc_score();
+        if (new_score < score) {
+            score = new_score;
+            search_report(score);
+        } else {
+            std::swap(Y[a], Y[b]);
+        }
+    }
+    if (sample > 0) {
+        _resync();
+        Y = best_Y;
+    }
+    for (int i = 0; i < N; i++) {
+        pos[i] = {X[i], Y[i]};
+    }
+    return pos;
+}
+
+// solve_greedyの配置から始める山登り法
+template<typename Policy = ScorePolicyDefault>
+std::vector<std::pair<int, int>> solve_climbing(const ProblemContext &ctx, int time_end, int sample = 0, int resync = 1000) {
+    return solve_climbing<Policy>(ctx.size(), ctx.edges(), time_end, solve_greedy(ctx), sample, resync);
+}
+
+// 交差削減で並べた配置から始める山登り法
+// 交差削減には制限時間の半分までを使い, 残りを山登り法に使う
+template<typename Policy = ScorePolicyDefault>
+std::vector<std::pair<int, int>> solve_barycenter_climbing(const ProblemContext &ctx, int time_end, int sample = 0, int resync = 1000) {
+    timer<0>::set();
+    auto init = solve_barycenter(ctx, 24, false, time_end / 2);
+    int rest = std::max<long long>(0, time_end - timer<0>::elapse());
+    return solve_climbing<Policy>(ctx.size(), ctx.edges(), rest, init, sample, resync);
+}
+
+// Brandes-Köpfの配置から始める山登り法
+// Brandes-Köpfには制限時間の半分までを使い, 残りを山登り法に使う
+template<typename Policy = ScorePolicyDefault>
+std::vector<std::pair<int, int>> solve_brandes_kopf_climbing(const ProblemContext &ctx, int time_end, int sample = 0, int resync = 1000) {
+    timer<0>::set();
+    auto init = solve_brandes_kopf<Policy>(ctx, time_end / 2);
+    int rest = std::max<long long>(0, time_end - timer<0>::elapse());
+    return solve_climbing<Policy>(ctx.size(), ctx.edges(), rest, init, sample, resync);
+}
+
+// 繰り返し現れる部分工程を1回だけ配置して使い回し, 残りを山登り法で配置する
+template<typename Policy = ScorePolicyDefault>
+std::vector<std::pair<int, int>> solve_motif(const ProblemContext &ctx, int time_end) {
+    return solve_by_motif<Policy>(ctx.size(), ctx.edges(), find_motifs(ctx), time_end, [](int n, const std::vector<std::pair<int, int>> &e, int t) {
+        return solve_climbing<Policy>(ProblemContext(n, e), t);
+    });
+}
+
+// 手法名 -> 手法
+// "gr" : solve_greedy, "perm" : solve_perm, "lp" : solve_long_path, "cl" : solve_climbing
+// "ml" : solve_multilevel, "bc" : solve_barycenter, "bccl" : solve_barycenter_climbing
+// "ns" : solve_network_simplex, "bk" : solve_brandes_kopf, "bkcl" : solve_brandes_kopf_climbing
+// "mt" : solve_motif
+// sample, resync := 山登り法(cl, bccl, bkcl)の受理の判定に使う辺の標本 (solve_climbingを参照), 他の手法では使わない
+bool is_engine(const std::string &name) {
+    return name == "gr" || name == "perm" || name == "lp" || name == "cl" || name == "ml" || name == "bc" || name == "bccl" || name == "ns" || name == "bk" || name == "bkcl" || name == "mt";
+}
+
+template<typename Policy = ScorePolicyDefault>
+std::vector<std::pair<int, int>> solve(const std::string &name, const ProblemContext &ctx, int time_end, int sample = 0, int resync = 1000) {
+    assert(is_engine(name));
+    if (name == "gr") return solve_greedy(ctx);
+    if (name == "ns") return solve_network_simplex(ctx, time_end);
+    if (name == "bk") return solve_brandes_kopf<Policy>(ctx, time_end);
+    if (name == "bkcl") return solve_brandes_kopf_climbing<Policy>(ctx, time_end, sample, resync);
+    if (name == "mt") return solve_motif<Policy>(ctx, time_end);
+    if (name == "perm") return solve_perm<Policy>(ctx, time_end);
+    if (name == "lp") return solve_long_path<Policy>(ctx, time_end);
+    if (name == "ml") return solve_multilevel<Policy>(ctx, time_end);
+    if (name == "bc") return solve_barycenter(ctx, 24, false, time_end);
+    if (name == "bccl") return solve_barycenter_climbing<Policy>(ctx, time_end, sample, resync);
+    return solve_climbing<Policy>(ctx, time_end, sample, resync);
+}
+
+// 文脈をその場で作って呼ぶ (1つの入力に1つの手法しか使わない場合)
+template<typename Policy = ScorePolicyDefault>
+std::vector<std::pair<int, int>> solve(const std::string &name, int N, const std::vector<std::pair<int, int>> &E, int time_end, int sample = 0, int resync = 1000) {
+    return solve<Policy>(name, ProblemContext(N, E), time_end, sample, resync);
+}
+#endif
@@ -1,5 +1,7 @@
 #include "CheckLib.hpp"
 #include "Lib.hpp"
+#include "Engine.hpp"
+#include "ParallelScore.hpp"
 
 int main() {
     std::string path_in = "../testcase/case1.csv";
@@ -14,30 +16,19 @@ int main() {
     }
 
     E = remove_multiple_edge(E);
+    renumber(mp, E);
     int N = mp.size();
-    auto G = adjacency_list(N, E);
-    // 各工程の横軸の座標を決定
-    auto X = calc_min_x(G);
-
-    // 縦方向の座標を上から決める
-    std::vector<int> Y(N), xcnt(N, 0);
-    for (int i = 0; i < N; i++) {
-        int x = X[i];
-        Y[i] = xcnt[x];
-        xcnt[x]++;
-    }
-
-    std::vector<std::pair<int, int>> pos(N);
-    for (int i = 0; i < N; i++) {
-        pos[i] = {X[i], Y[i]};
-    }
+    ProblemContext ctx(N, E);
+    // 横軸はcalc_min_x, 縦方向の座標を上から決める
+    auto pos = solve_greedy(ctx);
 
     // スコア計算
-    double score = calc_score(pos, E);
+    auto metrics = evaluate_layout_parallel(pos, E, LayoutMetrics::required<ScorePolicyDefault>() | LayoutMetrics::Cross | LayoutMetrics::BadPenetration);
+    double score = metrics.score<ScorePolicyDefault>();
     std::cout << "score is " << score << '\n';
-    std::cout << "lensum is " << sum_edge_length(pos, E) << '\n';
-    std::cout << "cross is " << count_edge_cross(pos, E) << '\n';
-    std::cout << "penetration is " << count_bad_penetration(pos, E) << '\n';
+    std::cout << "lensum is " << metrics.length << '\n';
+    std::cout << "cross is " << metrics.cross << '\n';
+    std::cout << "penetration is " << metrics.bad_penetration << '\n';
 
 
     // 答えを作成
@@ -1,7 +1,7 @@
 #include "CheckLib.hpp"
 #include "Lib.hpp"
-#include "SimulatedAnnealing.hpp"
-#include <numeric>
+#include "Engine.hpp"
+#include "ParallelScore.hpp"
 
 int main() {
     std::string path_in = "../testcase/case1.csv";
@@ -17,49 +17,25 @@ int main() {
         E.push_back({sid, tid});
     }
     E = remove_multiple_edge(E);
+    renumber(mp, E);
     int N = mp.size();
-    auto G = adjacency_list(N, E);
-    auto X = calc_min_x(G);
-    auto P = decompose_long_path(G);
-    int K = P.size();
+    ProblemContext ctx(N, E);
+    // 下界に達するか, time_end / 2 の間改善しなければ打ち切る
+    SearchControl control;
+    control.lower_bound = calc_lower_bound(ctx);
+    control.gap = 0;
+    control.stagnation_ms = time_end / 2;
+    search_control = &control;
     std::vector<std::tuple<std::string, int, int>> ans(N);
-    std::vector<std::pair<int, int>> pos;
-
-    if (K <= 6) {
-        std::vector<int> perm(K);
-        std::iota(perm.begin(), perm.end(), 0);
-        double min_score = std::numeric_limits<double>::max();
-        auto min_perm = perm;
-        do {
-            pos = compress_y(P, perm, X);
-            double score = calc_score(pos, E);
-            if (score < min_score) {
-                min_score = score;
-                min_perm = perm;
-            }
-        } while (std::next_permutation(perm.begin(), perm.end()));
-        pos = compress_y(P, min_perm, X);
-    } else {
-        double min_score = std::numeric_limits<double>::max();
-        std::vector<int> min_perm(K);
-        std::iota(min_perm.begin(), min_perm.end(), 0);
-        timer<0>::set();
-        while (timer<0>::elapse() <= time_end) {
-            auto perm = rng.random_permutation(K);
-            pos = compress_y(P, perm, X);
-            double score = calc_score(pos, E);
-            if (score < min_score) {
-                min_score = score;
-                min_perm = perm;
-            }
-        }
-        pos = compress_y(P, min_perm, X);
-    }
-    double score = calc_score(pos, E);
+    auto pos = solve_perm(ctx, time_end);
+    // スコア計算
+    auto metrics = evaluate_layout_parallel(pos, E, LayoutMetrics::required<ScorePolicyDefault>() | LayoutMetrics::Cross | LayoutMetrics::BadPenetration);
+    double score = metrics.score<ScorePolicyDefault>();
     std::cout << "score is " << score << '\n';
-    std::cout << "lensum is " << sum_edge_length(pos, E) << '\n';
-    std::cout << "cross is " << count_edge_cross(pos, E) << '\n';
-    std::cout << "penetration is " << count_bad_penetration(pos, E) << '\n';
+    std::cout << "gap is " << calc_gap(score, control.lower_bound) << '\n';
+    std::cout << "lensum is " << metrics.length << '\n';
+    std::cout << "cross is " << metrics.cross << '\n';
+    std::cout << "penetration is " << metrics.bad_penetration << '\n';
 
     for (int i = 0; i < N; i++) {
         ans[i] = {mp.get_process(i), pos[i].first, pos[i].second};
@@ -0,0 +1,213 @@
+#ifndef _LAYERED_H_
+#define _LAYERED_H_
+#include "Lib.hpp"
+#include "ProblemContext.hpp"
+#include "SimulatedAnnealing.hpp"
+#include "SearchControl.hpp"
+#include <numeric>
+#include <limits>
+
+/*
+calc_min_xで決まる列を層とみなして, 各列の中の並び順を決める(Sugiyama法の交差削減)
+2列以上またぐ辺は間の列にダミー頂点を置いて隣接する列の間の辺だけにする
+1. 前の列から順に, 前の列の隣接頂点の位置の重心(または中央値)で並べ替える(下向き)
+2. 後ろの列から順に, 次の列の隣接頂点で並べ替える(上向き)
+3. 隣り合う2頂点を入れ替えると交差が減る場合入れ替える(transpose)
+を繰り返して交差数が最小の並びを採用する
+制限時間を渡した場合は, 時間切れか打ち切りの要求(search_stop_requested)があればその時点までの最良の並びを返す
+*/
+
+// ダミー頂点を加えた層グラフ
+struct LayeredGraph {
+    int N; // 元の工程数, [0, N)が工程で[N, V)がダミー頂点
+    int V; // ダミー頂点を含む頂点数
+    std::vector<int> X; // 各頂点の列
+    std::vector<int> Y; // 各頂点の列の中での位置
+    std::vector<std::vector<int>> layer; // layer[x] := 列xの頂点を上から並べたもの
+    std::vector<std::vector<int>> prv, nxt; // 前の列の隣接頂点, 次の列の隣接頂点
+
+    LayeredGraph(int _N, const std::vector<std::pair<int, int>> &E, const std::vector<int> &_X) : N(_N), V(_N), X(_X) {
+        int L = 0;
+        for (int x : X) L = std::max(L, x + 1);
+        prv.resize(N);
+        nxt.resize(N);
+        auto add_edge = [&](int s, int t) {
+            nxt[s].push_back(t);
+            prv[t].push_back(s);
+        };
+        for (auto [s, t] : E) {
+            assert(X[s] < X[t]);
+            int v = s;
+            for (int x = X[s] + 1; x < X[t]; x++) {
+                X.push_back(x);
+                prv.push_back({});
+                nxt.push_back({});
+                add_edge(v, V);
+                v = V++;
+            }
+            add_edge(v, t);
+        }
+        layer.resize(L);
+        Y.resize(V);
+        for (int v = 0; v < V; v++) {
+            Y[v] = layer[X[v]].size();
+            layer[X[v]].push_back(v);
+        }
+    }
+
+    // 列xを並べ替えた後にYを更新
+    void update_y(int x) {
+        for (int i = 0; i < layer[x].size(); i++) {
+            Y[layer[x][i]] = i;
+        }
+    }
+
+    // 列xと列x+1の間の辺の交差数
+    // 列xの上から順に辺を見て, 列x+1側の位置の転倒数を数える
+    // O(M log M)
+    long long count_cross(int x) const {
+        int W = layer[x + 1].size();
+        std::vector<int> bit(W + 1, 0);
+        long long ans = 0, cnt = 0;
+        std::vector<int> to;
+        for (int s : layer[x]) {
+            to.clear();
+            for (int t : nxt[s]) to.push_back(Y[t]);
+            std::sort(to.begin(), to.end());
+            // 自分より下(位置が大きい)に出る, 既に見た辺の数
+            for (int y : to) {
+                long long le = 0;
+                for (int i = y + 1; i > 0; i -= i & -i) le += bit[i];
+                ans += cnt - le;
+            }
+            for (int y : to) {
+                for (int i = y + 1; i <= W; i += i & -i) bit[i]++;
+                cnt++;
+            }
+        }
+        return ans;
+    }
+
+    // 全体の交差数
+    long long count_cross() const {
+        long long ans = 0;
+        for (int x = 0; x + 1 < (int)layer.size(); x++) ans += count_cross(x);
+        return ans;
+    }
+
+    // 列xを隣接する列(down := 前の列, !down := 次の列)の位置の重心または中央値で並べ替える
+    // 隣接頂点が無い頂点は今の位置を保つ
+    void sort_layer(int x, bool down, bool median) {
+        std::vector<std::pair<double, int>> key;
+        std::vector<int> p;
+        for (int v : layer[x]) {
+            p.clear();
+            for (int u : (down ? prv[v] : nxt[v])) p.push_back(Y[u]);
+            double k = Y[v];
+            if (!p.empty()) {
+                if (median) {
+                    std::sort(p.begin(), p.end());
+                    int m = p.size();
+                    k = (m % 2 == 1) ? p[m / 2] : (p[m / 2 - 1] + p[m / 2]) / 2.0;
+                } else {
+                    k = std::accumulate(p.begin(), p.end(), 0.0) / p.size();
+                }
+            }
+            key.push_back({k, v});
+        }
+        std::stable_sort(key.begin(), key.end(), [](auto a, auto b) { return a.first < b.first; });
+        for (int i = 0; i < key.size(); i++) layer[x][i] = key[i].second;
+        update_y(x);
+    }
+
+    // uがvより上にあるときのu, vから出る(入る)辺同士の交差数
+    long long pair_cross(int u, int v) const {
+        long long ans = 0;
+        for (auto A : {&prv, &nxt}) {
+            for (int a : (*A)[u]) {
+                for (int b : (*A)[v]) {
+                    if (Y[a] > Y[b]) ans++;
+                }
+            }
+        }
+        return ans;
+    }
+
+    // 隣り合う2頂点を入れ替えて交差が減るなら入れ替える. 改善が無くなるまで繰り返す
+    // pair_crossは次数の積だけかかるので, 1回の呼び出しで見る辺の組の数をmax_workまでにする (負なら 64 * (V + 辺数))
+    // stop() がtrueになったら列の区切りでやめる
+    template<typename Stop>
+    void transpose(int max_iter, long long max_work, Stop stop) {
+        if (max_work < 0) {
+            long long M = 0;
+            for (auto &a : nxt) M += a.size();
+            max_work = 64 * (V + M);
+        }
+        long long work = 0;
+        for (int it = 0; it < max_iter; it++) {
+            bool improved = false;
+            for (int x = 0; x < layer.size(); x++) {
+                if (work > max_work || stop()) return;
+                for (int i = 0; i + 1 < layer[x].size(); i++) {
+                    int u = layer[x][i], v = layer[x][i + 1];
+                    work += 2 * ((long long)prv[u].size() * prv[v].size() + (long long)nxt[u].size() * nxt[v].size()) + 1;
+                    if (pair_cross(u, v) > pair_cross(v, u)) {
+                        std::swap(layer[x][i], layer[x][i + 1]);
+                        Y[u] = i + 1;
+                        Y[v] = i;
+                        improved = true;
+                    }
+                }
+            }
+            if (!improved) break;
+        }
+    }
+
+    void transpose(int max_iter = 10) {
+        transpose(max_iter, -1, []() { return false; });
+    }
+};
+
+// 列の中の並び順を交差削減で決め, 交差数が最小の並びをLGに入れる
+// sweeps := 下向き, 上向きの組を何回繰り返すか
+// median := 重心の代わりに中央値を使うか
+// time_end := 制限時間(ms), 負なら制限しない
+void order_layers(LayeredGraph &LG, int sweeps = 24, bool median = false, int time_end = -1) {
+    timer<2>::set();
+    auto stop = [&]() { return (time_end >= 0 && timer<2>::elapse() >= time_end) || search_stop_requested(); };
+    int L = LG.layer.size();
+    long long best = LG.count_cross();
+    auto best_layer = LG.layer;
+    for (int it = 0; it < sweeps && best > 0 && !stop(); it++) {
+        for (int x = 1; x < L; x++) LG.sort_layer(x, true, median);
+        for (int x = L - 2; x >= 0; x--) LG.sort_layer(x, false, median);
+        LG.transpose(10, -1, stop);
+        long long c = LG.count_cross();
+        if (c < best) {
+            best = c;
+            best_layer = LG.layer;
+        } else if (c == best) {
+            break;
+        }
+    }
+    LG.layer = best_layer;
+    for (int x = 0; x < L; x++) LG.update_y(x);
+}
+
+// 横軸はcalc_min_x, 列の中の並び順を交差削減で決める
+// 工程のy座標はダミー頂点を除いた列の中での順位
+// time_end := 制限時間(ms), 負なら制限しない
+std::vector<std::pair<int, int>> solve_barycenter(const ProblemContext &ctx, int sweeps = 24, bool median = false, int time_end = -1) {
+    int N = ctx.size();
+    LayeredGraph LG(N, ctx.edges(), ctx.min_x());
+    order_layers(LG, sweeps, median, time_end);
+    std::vector<std::pair<int, int>> pos(N);
+    for (int x = 0; x < LG.layer.size(); x++) {
+        int y = 0;
+        for (int v : LG.layer[x]) {
+            if (v < N) pos[v] = {x, y++};
+        }
+    }
+    return pos;
+}
+#endif
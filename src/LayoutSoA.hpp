@@ -0,0 +1,172 @@
+#ifndef _LAYOUT_SOA_H_
+#define _LAYOUT_SOA_H_
+#include <vector>
+#include <cmath>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define LAYOUT_SOA_X86
+#endif
+
+/*
+配置と辺集合をx座標, y座標, 始点, 終点の別々の配列で持つ(Structure of Arrays)
+辺の長さの総和をSIMD(AVX2/SSE2)でまとめて計算する
+x86ではAVX2が使えるかを実行時に判定し, 使えなければSSE2, x86以外ではスカラーで計算する
+和を取る順番が異なるので, Lib.hppの同名の関数と丸め誤差の範囲で値がずれることがある
+辺ごとの長さを配列に書き出す lengths は和を取らないので, std::sqrt で求めた値とビット単位で一致する
+(evaluate_layout_parallel はこれで長さを求めてから辺の順に足す)
+*/
+
+// 配置
+struct LayoutSoA {
+    std::vector<int> x, y;
+
+    LayoutSoA() {}
+    LayoutSoA(const std::vector<std::pair<int, int>> &pos) : x(pos.size()), y(pos.size()) {
+        for (int i = 0; i < pos.size(); i++) {
+            x[i] = pos[i].first;
+            y[i] = pos[i].second;
+        }
+    }
+
+    int size() const {
+        return x.size();
+    }
+};
+
+// 辺集合
+struct EdgeSoA {
+    std::vector<int> s, t;
+
+    EdgeSoA() {}
+    EdgeSoA(const std::vector<std::pair<int, int>> &E) : s(E.size()), t(E.size()) {
+        for (int i = 0; i < E.size(); i++) {
+            s[i] = E[i].first;
+            t[i] = E[i].second;
+        }
+    }
+
+    int size() const {
+        return s.size();
+    }
+};
+
+namespace LayoutSoAKernel {
+    // [l, r)番目の辺の長さの和 (naname := 水平な辺を除くか)
+    double sum_scalar(const int *x, const int *y, const int *s, const int *t, int l, int r, bool naname) {
+        double ans = 0;
+        for (int i = l; i < r; i++) {
+            int dx = x[t[i]] - x[s[i]];
+            int dy = y[t[i]] - y[s[i]];
+            if (naname && dy == 0) continue;
+            ans += std::sqrt(dx * dx + dy * dy);
+        }
+        return ans;
+    }
+
+#ifdef LAYOUT_SOA_X86
+    // 8本ずつgatherで座標を集めて4本ずつsqrtを取る
+    __attribute__((target("avx2")))
+    double sum_avx2(const int *x, const int *y, const int *s, const int *t, int M, bool naname) {
+        __m256d acc0 = _mm256_setzero_pd(), acc1 = _mm256_setzero_pd();
+        const __m256i zero = _mm256_setzero_si256();
+        int i = 0;
+        for (; i + 8 <= M; i += 8) {
+            __m256i is = _mm256_loadu_si256((const __m256i *)(s + i));
+            __m256i it = _mm256_loadu_si256((const __m256i *)(t + i));
+            __m256i dx = _mm256_sub_epi32(_mm256_i32gather_epi32(x, it, 4), _mm256_i32gather_epi32(x, is, 4));
+            __m256i dy = _mm256_sub_epi32(_mm256_i32gather_epi32(y, it, 4), _mm256_i32gather_epi32(y, is, 4));
+            __m256i d2 = _mm256_add_epi32(_mm256_mullo_epi32(dx, dx), _mm256_mullo_epi32(dy, dy));
+            if (naname) {
+                // dy == 0 の辺は長さ0として扱う
+                d2 = _mm256_andnot_si256(_mm256_cmpeq_epi32(dy, zero), d2);
+            }
+            __m256d lo = _mm256_sqrt_pd(_mm256_cvtepi32_pd(_mm256_castsi256_si128(d2)));
+            __m256d hi = _mm256_sqrt_pd(_mm256_cvtepi32_pd(_mm256_extracti128_si256(d2, 1)));
+            acc0 = _mm256_add_pd(acc0, lo);
+            acc1 = _mm256_add_pd(acc1, hi);
+        }
+        alignas(32) double buf[4];
+        _mm256_store_pd(buf, _mm256_add_pd(acc0, acc1));
+        return buf[0] + buf[1] + buf[2] + buf[3] + sum_scalar(x, y, s, t, i, M, naname);
+    }
+
+    // SSE2にはgatherが無いので座標はスカラーで集めて2本ずつsqrtを取る
+    double sum_sse2(const int *x, const int *y, const int *s, const int *t, int M, bool naname) {
+        __m128d acc = _mm_setzero_pd();
+        int i = 0;
+        for (; i + 2 <= M; i += 2) {
+            int dx0 = x[t[i]] - x[s[i]], dy0 = y[t[i]] - y[s[i]];
+            int dx1 = x[t[i + 1]] - x[s[i + 1]], dy1 = y[t[i + 1]] - y[s[i + 1]];
+            int d0 = (naname && dy0 == 0) ? 0 : dx0 * dx0 + dy0 * dy0;
+            int d1 = (naname && dy1 == 0) ? 0 : dx1 * dx1 + dy1 * dy1;
+            acc = _mm_add_pd(acc, _mm_sqrt_pd(_mm_set_pd(d1, d0)));
+        }
+        alignas(16) double buf[2];
+        _mm_store_pd(buf, acc);
+        return buf[0] + buf[1] + sum_scalar(x, y, s, t, i, M, naname);
+    }
+
+    // [l, r)番目の辺の長さをout[l], ..., out[r - 1]に書く
+    __attribute__((target("avx2")))
+    void lengths_avx2(const int *x, const int *y, const int *s, const int *t, int l, int r, double *out) {
+        int i = l;
+        for (; i + 8 <= r; i += 8) {
+            __m256i is = _mm256_loadu_si256((const __m256i *)(s + i));
+            __m256i it = _mm256_loadu_si256((const __m256i *)(t + i));
+            __m256i dx = _mm256_sub_epi32(_mm256_i32gather_epi32(x, it, 4), _mm256_i32gather_epi32(x, is, 4));
+            __m256i dy = _mm256_sub_epi32(_mm256_i32gather_epi32(y, it, 4), _mm256_i32gather_epi32(y, is, 4));
+            __m256i d2 = _mm256_add_epi32(_mm256_mullo_epi32(dx, dx), _mm256_mullo_epi32(dy, dy));
+            _mm256_storeu_pd(out + i, _mm256_sqrt_pd(_mm256_cvtepi32_pd(_mm256_castsi256_si128(d2))));
+            _mm256_storeu_pd(out + i + 4, _mm256_sqrt_pd(_mm256_cvtepi32_pd(_mm256_extracti128_si256(d2, 1))));
+        }
+        for (; i < r; i++) {
+            int dx = x[t[i]] - x[s[i]];
+            int dy = y[t[i]] - y[s[i]];
+            out[i] = std::sqrt(dx * dx + dy * dy);
+        }
+    }
+
+    bool has_avx2() {
+        static const bool ok = __builtin_cpu_supports("avx2");
+        return ok;
+    }
+#endif
+
+    double sum(const LayoutSoA &pos, const EdgeSoA &E, bool naname) {
+        const int *x = pos.x.data(), *y = pos.y.data(), *s = E.s.data(), *t = E.t.data();
+        int M = E.size();
+#ifdef LAYOUT_SOA_X86
+        if (has_avx2()) return sum_avx2(x, y, s, t, M, naname);
+        return sum_sse2(x, y, s, t, M, naname);
+#else
+        return sum_scalar(x, y, s, t, 0, M, naname);
+#endif
+    }
+
+    // [l, r)番目の辺の長さをout[l], ..., out[r - 1]に書く
+    void lengths(const LayoutSoA &pos, const EdgeSoA &E, int l, int r, double *out) {
+        const int *x = pos.x.data(), *y = pos.y.data(), *s = E.s.data(), *t = E.t.data();
+#ifdef LAYOUT_SOA_X86
+        if (has_avx2()) {
+            lengths_avx2(x, y, s, t, l, r, out);
+            return;
+        }
+#endif
+        for (int i = l; i < r; i++) {
+            int dx = x[t[i]] - x[s[i]];
+            int dy = y[t[i]] - y[s[i]];
+            out[i] = std::sqrt(dx * dx + dy * dy);
+        }
+    }
+};
+
+// 辺の長さの総和を返す
+double sum_edge_length(const LayoutSoA &pos, const EdgeSoA &E) {
+    return LayoutSoAKernel::sum(pos, E, false);
+}
+
+// 斜めの辺の長さの総和
+double sum_edge_length_naname(const LayoutSoA &pos, const EdgeSoA &E) {
+    return LayoutSoAKernel::sum(pos, E, true);
+}
+#endif
@@ -1,112 +1,17 @@
 #include "CheckLib.hpp"
 #include "Lib.hpp"
 #include "SimulatedAnnealing.hpp"
+#include "StateSA.hpp"
+#include "ProblemContext.hpp"
+#include "NetworkSimplex.hpp"
+#include "ParallelScore.hpp"
 #include <numeric>
-
-struct StateSA {
-    using UpdateType = std::tuple<int, int, int>;
-    using ScoreType = double;
-    ScoreType score;
-    std::vector<int> perm;
-    int N;
-    std::tuple<int, int, int> last_query;
-    double last_score;
-    std::vector<std::vector<int>> P;
-    std::vector<int> minX, curX, ord;
-    std::vector<std::pair<int, int>> E;
-    std::vector<std::vector<int>> G;
-
-    StateSA(std::vector<std::vector<int>> _P, std::vector<int> _X, std::vector<std::pair<int, int>> _E) : score(std::numeric_limits<double>::max()), perm(_P.size()), N(_X.size()), P(_P), minX(_X), curX(_X), E(_E), G(adjacency_list(N, E)) {
-        std::iota(perm.begin(), perm.end(), 0);
-        auto tmpX = curX;
-        auto pos = compress_y(P, perm, tmpX);
-        score = calc_score(pos, E);
-
-        std::vector<int> in(N, 0), X(N);
-        for (int i = 0; i < N; i++) {
-            for (int t : G[i]) {
-                in[t]++;
-            }
-        }
-        std::queue<int> que;
-        for (int i = 0; i < N; i++) {
-            if (in[i] == 0) {
-                que.push(i);
-            }
-        }
-        while (!que.empty()) {
-            int s = que.front();
-            que.pop();
-            ord.push_back(s);
-            for (int t : G[s]) {
-                in[t]--;
-                if (in[t] == 0) {
-                    que.push(t);
-                }
-            }
-        }
-    }
-
-    std::vector<int> make_tmpX() {
-        auto tmpX = curX;
-        for (int s : ord) {
-            for (int t : G[s]) {
-                tmpX[t] = std::max(tmpX[t], tmpX[s] + 1);
-            }
-        }
-        return tmpX;
-    }
-
-    void random_update() {
-        int M = P.size();
-        int type = rng.random_number() % 3;
-        //type = 0;
-        if (type == 0) {
-            int a = rng.random_number() % M;
-            int b = rng.random_number() % M;
-            std::swap(perm[a], perm[b]);
-            last_query = {0, a, b};
-        } else if (type == 1) {
-            int a = rng.random_number() % N;
-            last_query = {1, a, 1};
-            curX[a]++;
-        } else {
-            int a = rng.random_number() % N;
-            if (curX[a] == minX[a]) {
-                last_query = {2, a, 0};
-            } else {
-                last_query = {2, a, 1};
-                curX[a]--;
-            }
-        }
-        last_score = score;
-        auto tmpX = make_tmpX();
-        auto pos = compress_y(P, perm, tmpX);
-        score = calc_score(pos, E);
-    }
-
-    void rollback() {
-        auto [type, a, b] = last_query;
-        if (type == 0) {
-            std::swap(perm[a], perm[b]);
-            score = last_score;
-        } else if (type == 1) {
-            curX[a]--;
-            score = last_score;
-        } else {
-            curX[a] += b;
-            score = last_score;
-        }
-    }
-
-    ScoreType get_score() {
-        return score;
-    }
-};
+#include <filesystem>
 
 int main() {
     std::string path_in = "../testcase/case1.csv";
     std::string path_out = "../testcase/case1_lp.csv";
+    std::string path_ckpt = "../testcase/case1_lp.ckpt"; // 焼きなましのチェックポイント
     assert(CheckLib::is_valid_input(path_in));
     std::vector<std::pair<int, int>> E;
     ProcessMap mp;
@@ -116,30 +21,68 @@ int main() {
         E.push_back({sid, tid});
     }
     E = remove_multiple_edge(E);
+    renumber(mp, E);
     int N = mp.size();
-    auto G = adjacency_list(N, E);
-    auto X = calc_min_x(G);
-    auto P = decompose_long_path(G);
+    ProblemContext ctx(N, E);
 
     std::vector<std::tuple<std::string, int, int>> ans(N);
     std::vector<std::pair<int, int>> pos;
 
-    StateSA sa(P, X, E);
-    simulated_annealing<timer<0>, temperature_scheduler_exp<0>, StateSA>()(sa, 1000, 0.1, 2000, 1);
-    //pos = compress_y(P, sa.perm, sa.make_tmpX());
-    
-    pos.resize(N);
-    for (int i = 0; i < N; i++) {
-        
+    auto make_ans = [&](const std::vector<std::pair<int, int>> &pos) {
+        for (int i = 0; i < N; i++) {
+            ans[i] = {mp.get_process(i), pos[i].first, pos[i].second};
+        }
+        return ans;
+    };
+
+    // チェックポイントがあればそこから再開
+    const int time_end = 2000;
+    const int report_interval = 500; // 途中経過を出力する間隔(ms)
+    StateSA<> sa(ctx);
+    // 温度は初期状態から決める (再開時もチェックポイントを読む前に同じ値を求めておく)
+    // 調整と下界の計算にかかった時間は焼きなましの時間に含める (その分だけ進んだ温度から始める)
+    long long calibrate_start = timems();
+    auto [T0, T1] = calibrate_temperature(sa, 1000, 0.5, 0.001, time_end / 10);
+    // 下界に達したら打ち切る (焼きなましは序盤に改善しないことがあるので停滞では打ち切らない)
+    // x座標も動かすので, calc_min_xの列での下界ではなく横軸を自由に選んだ場合の下界を使う
+    SearchControl control;
+    control.lower_bound = calc_lower_bound_free_x(ctx, time_end / 10);
+    control.gap = 0;
+    long long calibrate_ms = timems() - calibrate_start;
+    int time_start = 0;
+    if (std::filesystem::is_regular_file(path_ckpt)) {
+        std::ifstream ifs(path_ckpt);
+        long long elapse = sa.load(ifs);
+        if (elapse != -1) {
+            time_start = std::min<long long>(elapse, time_end);
+            std::cout << "resume from " << time_start << "ms\n";
+        }
     }
+    time_start = std::min<long long>(time_start + calibrate_ms, time_end);
+
+    // 最良解とチェックポイントを一定間隔で書き出す
+    auto report = [&](StateSA<> &v, long long elapse) {
+        CheckLib::write_csv_atomic(path_out, make_ans(v.best_pos()));
+        std::string path_tmp = path_ckpt + ".tmp";
+        {
+            std::ofstream ofs(path_tmp);
+            v.save(ofs, elapse);
+        }
+        std::filesystem::rename(path_tmp, path_ckpt);
+    };
+    search_control = &control;
+    simulated_annealing<timer<0>, temperature_scheduler_reheat<0>, StateSA<>>()(sa, T0, T1, time_end, 1, time_start, report_interval, report);
+    pos = sa.best_pos();
+    // 最後まで焼きなましたらチェックポイントは消す (残すと次の実行が終了時刻から再開して何もしない)
+    std::filesystem::remove(path_ckpt);
     
-    double score = calc_score(pos, E);
+    // スコア計算
+    auto metrics = evaluate_layout_parallel(pos, E, LayoutMetrics::required<ScorePolicyDefault>() | LayoutMetrics::Cross | LayoutMetrics::BadPenetration);
+    double score = metrics.score<ScorePolicyDefault>();
     std::cout << "score is " << score << '\n';
-    std::cout << "lensum is " << sum_edge_length(pos, E) << '\n';
-    std::cout << "cross is " << count_edge_cross(pos, E) << '\n';
-    std::cout << "penetration is " << count_bad_penetration(pos, E) << '\n';
-    for (int i = 0; i < N; i++) {
-        ans[i] = {mp.get_process(i), pos[i].first, pos[i].second};
-    }
-    CheckLib::write_csv(path_out, ans);
+    std::cout << "gap is " << calc_gap(score, control.lower_bound) << '\n';
+    std::cout << "lensum is " << metrics.length << '\n';
+    std::cout << "cross is " << metrics.cross << '\n';
+    std::cout << "penetration is " << metrics.bad_penetration << '\n';
+    CheckLib::write_csv_atomic(path_out, make_ans(pos));
 }
\ No newline at end of file
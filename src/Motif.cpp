@@ -0,0 +1,50 @@
+#include "CheckLib.hpp"
+#include "Lib.hpp"
+#include "Engine.hpp"
+#include "Motif.hpp"
+#include "ParallelScore.hpp"
+
+// 繰り返し現れる部分工程を1回だけ配置して使い回し, 残りを指定した手法で配置する
+int main() {
+    std::string path_in = "../testcase/case1.csv";
+    std::string path_out = "../testcase/case1_mt.csv";
+    std::string engine = "cl"; // モチーフの代表と外側の問題に使う手法 (Engine.hppのsolveを参照)
+    int time_end = 2000;
+
+    assert(CheckLib::is_valid_input(path_in));
+    assert(is_engine(engine));
+    std::vector<std::pair<int, int>> E;
+    ProcessMap mp;
+    for (auto [s, t] : CheckLib::read_csv(path_in)) {
+        int sid = mp.register_process(s);
+        int tid = mp.register_process(t);
+        E.push_back({sid, tid});
+    }
+    E = remove_multiple_edge(E);
+    renumber(mp, E);
+    int N = mp.size();
+    ProblemContext ctx(N, E);
+    int occurrence = 0;
+    auto motifs = find_motifs(ctx);
+    for (const auto &g : motifs) occurrence += g.size();
+    std::cout << "motif is " << motifs.size() << " (" << occurrence << " regions)" << '\n';
+
+    auto solver = [&](int n, const std::vector<std::pair<int, int>> &e, int t) {
+        return solve(engine, n, e, t);
+    };
+    auto pos = solve_by_motif(N, E, motifs, time_end, solver);
+
+    // スコア計算
+    auto metrics = evaluate_layout_parallel(pos, E, LayoutMetrics::required<ScorePolicyDefault>() | LayoutMetrics::Cross | LayoutMetrics::BadPenetration);
+    double score = metrics.score<ScorePolicyDefault>();
+    std::cout << "score is " << score << '\n';
+    std::cout << "lensum is " << metrics.length << '\n';
+    std::cout << "cross is " << metrics.cross << '\n';
+    std::cout << "penetration is " << metrics.bad_penetration << '\n';
+
+    std::vector<std::tuple<std::string, int, int>> ans(N);
+    for (int i = 0; i < N; i++) {
+        ans[i] = {mp.get_process(i), pos[i].first, pos[i].second};
+    }
+    CheckLib::write_csv(path_out, ans);
+}
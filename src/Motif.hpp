@@ -0,0 +1,314 @@
+#ifndef _MOTIF_H_
+#define _MOTIF_H_
+#include "Lib.hpp"
+#include "ScoreCache.hpp"
+#include "SimulatedAnnealing.hpp"
+#include "ProblemContext.hpp"
+#include <algorithm>
+#include <numeric>
+#include <map>
+#include <limits>
+
+/*
+繰り返し現れる部分工程(モチーフ)を1回だけ配置して使い回す
+1. 入口と出口が1つずつの領域(SESE領域)を探す
+   工程aの直後支配点(aから終点へのどの経路も通る最初の工程)をbとし,
+   aからbを通らずに行ける工程(内側)に入る辺が全てaか内側からなら, a, 内側, b は1つの領域になる
+2. 領域の内側の各工程に, 出口側と入口側からの構造のハッシュ(Merkleハッシュ)を付けて正準な順に並べ,
+   その順での辺の集合が一致する領域どうしを同じモチーフとする (ハッシュが衝突しても辺の集合で確かめる)
+3. モチーフごとに代表の領域を1回だけ配置し, 外側の問題では各領域の内側を横一列に並んだ (内側の列数) 個の工程に置き換えて配置する
+4. 置き換えた工程の位置に代表の配置をそのまま(縦方向は固定で)はめ込み, 後ろの行を下にずらして場所を空ける
+5. はめ込んだ配置と, 使い回さずに全体を解いた配置のうちスコアが良い方を使う
+同じテンプレートの部分工程が何度も現れる入力では, 外側の問題が小さくなる
+*/
+
+// 入口entryと出口exitの間の工程innerからなる領域
+// innerと外との辺は entry -> inner と inner -> exit だけ
+struct MotifRegion {
+    int entry, exit;
+    std::vector<int> inner; // 正準な順 (同じモチーフの領域どうしはこの順で対応する)
+    std::vector<std::pair<int, int>> edges; // innerの正準な順の番号で表した辺 (入口は-1, 出口はinner.size()), 昇順
+    uint64_t hash; // 構造のハッシュ (同型なら等しい)
+};
+
+/*
+内側の工程が2個以上max_size個以下の領域を全て求める (入口ごとに1つ, 出口は入口の直後支配点)
+ord := Gのトポロジカル順 (ProblemContextを渡す版は文脈のものを使う)
+O(N * (直後支配点の木の深さ) + (領域の大きさの和) * log)
+*/
+std::vector<MotifRegion> find_sese_regions(const CSRGraph &G, const std::vector<int> &ord, int max_size = 64) {
+    int N = G.size();
+    std::vector<int> topo(N);
+    assert(ord.size() == N);
+    for (int k = 0; k < N; k++) topo[ord[k]] = k;
+
+    // 直後支配点 (全ての終点の後ろに仮想的な工程Nを置く)
+    std::vector<int> ipdom(N + 1, N), depth(N + 1, 0);
+    for (int k = N - 1; k >= 0; k--) {
+        int v = ord[k], p = -1;
+        for (int t : G[v]) {
+            if (p == -1) {
+                p = t;
+                continue;
+            }
+            int u = t;
+            while (p != u) {
+                if (depth[p] < depth[u]) std::swap(p, u);
+                p = ipdom[p];
+            }
+        }
+        ipdom[v] = (p == -1 ? N : p);
+        depth[v] = depth[ipdom[v]] + 1;
+    }
+
+    const uint64_t EntryHash = Zobrist::mix(1), ExitHash = Zobrist::mix(2);
+    auto fold = [](std::vector<uint64_t> &buf) {
+        std::sort(buf.begin(), buf.end());
+        uint64_t h = Zobrist::mix(buf.size());
+        for (uint64_t x : buf) h = Zobrist::mix(h ^ x);
+        return h;
+    };
+
+    std::vector<MotifRegion> res;
+    std::vector<int> stamp(N, -1), lid(N), st;
+    std::vector<uint64_t> buf;
+    for (int a = 0; a < N; a++) {
+        int b = ipdom[a];
+        if (b == N) continue;
+        // aからbを通らずに行ける工程 (stamp[v] == a)
+        std::vector<int> inner;
+        st.assign(1, a);
+        while (!st.empty() && inner.size() <= max_size) {
+            int v = st.back();
+            st.pop_back();
+            for (int t : G[v]) {
+                if (t == b || stamp[t] == a) continue;
+                stamp[t] = a;
+                st.push_back(t);
+                inner.push_back(t);
+            }
+        }
+        if (inner.size() < 2 || inner.size() > max_size) continue;
+        bool ok = true;
+        for (int v : inner) {
+            for (int s : G.rev(v)) {
+                if (s != a && stamp[s] != a) ok = false;
+            }
+        }
+        if (!ok) continue;
+
+        // 出口側からのハッシュdownと入口側からのハッシュupを組にして正準な順を決める
+        int k = inner.size();
+        std::sort(inner.begin(), inner.end(), [&](int u, int v) { return topo[u] < topo[v]; });
+        for (int i = 0; i < k; i++) lid[inner[i]] = i;
+        std::vector<uint64_t> down(k), up(k), key(k);
+        for (int i = k - 1; i >= 0; i--) {
+            buf.clear();
+            for (int t : G[inner[i]]) buf.push_back(t == b ? ExitHash : down[lid[t]]);
+            down[i] = fold(buf);
+        }
+        for (int i = 0; i < k; i++) {
+            buf.clear();
+            for (int s : G.rev(inner[i])) buf.push_back(s == a ? EntryHash : up[lid[s]]);
+            up[i] = fold(buf);
+            key[i] = Zobrist::mix(down[i] ^ Zobrist::mix(up[i]));
+        }
+        std::vector<int> idx(k);
+        std::iota(idx.begin(), idx.end(), 0);
+        std::stable_sort(idx.begin(), idx.end(), [&](int i, int j) { return key[i] < key[j]; });
+
+        MotifRegion r;
+        r.entry = a;
+        r.exit = b;
+        for (int i : idx) r.inner.push_back(inner[i]);
+        for (int i = 0; i < k; i++) lid[r.inner[i]] = i;
+        for (int i = 0; i < k; i++) {
+            for (int s : G.rev(r.inner[i])) {
+                if (s == a) r.edges.push_back({-1, i});
+            }
+            for (int t : G[r.inner[i]]) r.edges.push_back({i, t == b ? k : lid[t]});
+        }
+        std::sort(r.edges.begin(), r.edges.end());
+        buf.assign(key.begin(), key.end());
+        r.hash = fold(buf);
+        res.push_back(r);
+    }
+    return res;
+}
+
+std::vector<MotifRegion> find_sese_regions(int N, const std::vector<std::pair<int, int>> &E, int max_size = 64) {
+    CSRGraph G(N, E);
+    return find_sese_regions(G, topological_order(G), max_size);
+}
+
+std::vector<MotifRegion> find_sese_regions(const ProblemContext &ctx, int max_size = 64) {
+    return find_sese_regions(ctx.graph(), ctx.topological_order(), max_size);
+}
+
+/*
+2回以上現れるモチーフを, 互いに重ならない領域の組として求める
+大きい領域から順に, 既に選んだ領域の内側と重ならないものを選ぶ
+R := find_sese_regionsで求めた領域
+返り値 : モチーフごとの領域の列 (先頭が代表)
+*/
+std::vector<std::vector<MotifRegion>> find_motifs(int N, std::vector<MotifRegion> R) {
+    std::map<uint64_t, int> cnt;
+    for (const auto &r : R) cnt[r.hash]++;
+    std::stable_sort(R.begin(), R.end(), [](const MotifRegion &a, const MotifRegion &b) { return a.inner.size() > b.inner.size(); });
+    std::vector<char> used(N, 0), end(N, 0); // 選んだ領域の内側, 入口か出口
+    std::map<uint64_t, std::vector<MotifRegion>> group;
+    for (auto &r : R) {
+        if (cnt[r.hash] < 2 || used[r.entry] || used[r.exit]) continue;
+        bool ok = true;
+        for (int v : r.inner) {
+            if (used[v] || end[v]) ok = false;
+        }
+        if (!ok) continue;
+        auto &g = group[r.hash];
+        if (!g.empty() && g[0].edges != r.edges) continue; // ハッシュの衝突
+        for (int v : r.inner) used[v] = 1;
+        end[r.entry] = end[r.exit] = 1;
+        g.push_back(std::move(r));
+    }
+    std::vector<std::vector<MotifRegion>> res;
+    for (auto &[h, g] : group) {
+        if (g.size() >= 2) res.push_back(std::move(g));
+    }
+    return res;
+}
+
+std::vector<std::vector<MotifRegion>> find_motifs(int N, const std::vector<std::pair<int, int>> &E, int max_size = 64) {
+    return find_motifs(N, find_sese_regions(N, E, max_size));
+}
+
+std::vector<std::vector<MotifRegion>> find_motifs(const ProblemContext &ctx, int max_size = 64) {
+    return find_motifs(ctx.size(), find_sese_regions(ctx, max_size));
+}
+
+/*
+モチーフ(find_motifsで求めたもの)を1回だけ配置して使い回し, 残りを solver(工程数, 辺集合, 制限時間(ms)) -> 配置 で配置する
+モチーフの代表は 入口, 内側, 出口 だけの問題として配置し, 制限時間は工程数に比例して配分する
+内側の列数が内側の工程数と同じモチーフ(1本の鎖)は置き換えても小さくならないので使わない
+*/
+template<typename Solver>
+std::vector<std::pair<int, int>> place_motifs(int N, const std::vector<std::pair<int, int>> &E, const std::vector<std::vector<MotifRegion>> &motifs, int time_end, Solver solver) {
+    int budget = time_end;
+
+    // モチーフごとの配置 rel[i] := inner[i]の (入口からの列 1..w, 行 0..h-1)
+    struct Block {
+        int w, h;
+        std::vector<std::pair<int, int>> rel;
+        std::vector<std::vector<char>> need; // need[c][d] := 列c, 行dに工程があるか
+    };
+    std::vector<Block> block;
+    std::vector<const MotifRegion *> occ; // 使う領域
+    std::vector<int> occ_block;
+    for (const auto &g : motifs) {
+        const auto &r = g[0];
+        int k = r.inner.size();
+        std::vector<std::pair<int, int>> e;
+        for (auto [s, t] : r.edges) e.push_back({s + 1, t + 1});
+        int t = std::max(1, (int)((long long)time_end * (k + 2) / N));
+        budget -= t;
+        auto pos = solver(k + 2, e, t);
+        Block bl;
+        bl.w = pos[k + 1].first - pos[0].first - 1;
+        int ly = std::numeric_limits<int>::max(), hy = std::numeric_limits<int>::min();
+        for (int i = 1; i <= k; i++) {
+            ly = std::min(ly, pos[i].second);
+            hy = std::max(hy, pos[i].second);
+        }
+        bl.h = hy - ly + 1;
+        bl.need.assign(bl.w + 1, std::vector<char>(bl.h, 0));
+        for (int i = 1; i <= k; i++) {
+            bl.rel.push_back({pos[i].first - pos[0].first, pos[i].second - ly});
+            bl.need[bl.rel.back().first][bl.rel.back().second] = 1;
+        }
+        if (bl.w >= k) continue;
+        for (const auto &o : g) {
+            occ.push_back(&o);
+            occ_block.push_back(block.size());
+        }
+        block.push_back(bl);
+    }
+
+    // 外側の問題: 内側を横一列に並んだw個の工程に置き換える
+    std::vector<int> oid(N, 0);
+    for (const auto *r : occ) {
+        for (int v : r->inner) oid[v] = -1;
+    }
+    int N2 = 0;
+    for (int v = 0; v < N; v++) {
+        if (oid[v] != -1) oid[v] = N2++;
+    }
+    std::vector<std::pair<int, int>> E2;
+    for (auto [s, t] : E) {
+        if (oid[s] != -1 && oid[t] != -1) E2.push_back({oid[s], oid[t]});
+    }
+    std::vector<int> chain(occ.size()); // 置き換えた工程の先頭の番号 (w個が連番)
+    for (int j = 0; j < occ.size(); j++) {
+        int w = block[occ_block[j]].w;
+        chain[j] = N2;
+        E2.push_back({oid[occ[j]->entry], N2});
+        for (int i = 0; i + 1 < w; i++) E2.push_back({N2 + i, N2 + i + 1});
+        E2.push_back({N2 + w - 1, oid[occ[j]->exit]});
+        N2 += w;
+    }
+    auto cur = solver(N2, remove_multiple_edge(E2), std::max(1, budget));
+
+    // はめ込む. 置き換えた工程が一直線ならその行から, そうでなければその下の行から置く
+    // 置く位置が空いていない列だけ, その行より下にある工程を列ごと下にずらす (列の中の順は変わらない)
+    std::vector<std::pair<int, int>> ans(N);
+    std::vector<int> placed;
+    std::vector<std::pair<int, int> *> items;
+    for (int j = 0; j < occ.size(); j++) {
+        const auto &bl = block[occ_block[j]];
+        int y0 = cur[chain[j]].second;
+        bool straight = true;
+        for (int i = 0; i < bl.w; i++) straight &= (cur[chain[j] + i].second == y0);
+        int shift = (straight ? bl.h - 1 : bl.h);
+        int base = (straight ? y0 : y0 + 1);
+        items.clear();
+        for (int u = 0; u < N2; u++) {
+            if (u < chain[j] || u >= chain[j] + bl.w) items.push_back(&cur[u]);
+        }
+        for (int v : placed) items.push_back(&ans[v]);
+        for (int c = 1; c <= bl.w; c++) {
+            int x = cur[chain[j] + c - 1].first;
+            bool conflict = false;
+            for (auto *p : items) {
+                if (p->first == x && p->second >= base && p->second < base + bl.h && bl.need[c][p->second - base]) conflict = true;
+            }
+            if (!conflict || shift == 0) continue;
+            for (auto *p : items) {
+                if (p->first == x && p->second > y0) p->second += shift;
+            }
+        }
+        for (int i = 0; i < occ[j]->inner.size(); i++) {
+            int v = occ[j]->inner[i];
+            auto [c, d] = bl.rel[i];
+            ans[v] = {cur[chain[j] + c - 1].first, base + d};
+            placed.push_back(v);
+        }
+    }
+    for (int v = 0; v < N; v++) {
+        if (oid[v] != -1) ans[v] = cur[oid[v]];
+    }
+    return ans;
+}
+
+/*
+place_motifsに制限時間の半分までを使い, 残りで全体をそのままsolverで解いて, calc_score<Policy>が良い方を返す
+はめ込みはモチーフの周りで行をずらすので, 使い回さずに解くより悪くなることがある
+*/
+template<typename Policy = ScorePolicyDefault, typename Solver>
+std::vector<std::pair<int, int>> solve_by_motif(int N, const std::vector<std::pair<int, int>> &E, const std::vector<std::vector<MotifRegion>> &motifs, int time_end, Solver solver) {
+    long long start = timems();
+    auto pos = place_motifs(N, E, motifs, time_end / 2, solver);
+    int rest = std::max<long long>(1, time_end - (timems() - start));
+    auto direct = solver(N, E, rest);
+    ScoreWorkspace ws;
+    if (calc_score<Policy>(direct, E, ws) < calc_score<Policy>(pos, E, ws)) return direct;
+    return pos;
+}
+#endif
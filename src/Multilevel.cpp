@@ -0,0 +1,39 @@
+#include "CheckLib.hpp"
+#include "Lib.hpp"
+#include "Engine.hpp"
+#include "ParallelScore.hpp"
+
+// 多段階法
+// 工程を連結してパスにしていき, 粗い段階で決めた並び順を細かい段階で修正する
+int main() {
+    std::string path_in = "../testcase/case1.csv";
+    std::string path_out = "../testcase/case1_ml.csv";
+    int time_end = 2000;
+
+    assert(CheckLib::is_valid_input(path_in));
+    std::vector<std::pair<int, int>> E;
+    ProcessMap mp;
+    for (auto [s, t] : CheckLib::read_csv(path_in)) {
+        int sid = mp.register_process(s);
+        int tid = mp.register_process(t);
+        E.push_back({sid, tid});
+    }
+    E = remove_multiple_edge(E);
+    renumber(mp, E);
+    int N = mp.size();
+    ProblemContext ctx(N, E);
+    std::vector<std::tuple<std::string, int, int>> ans(N);
+    auto pos = solve_multilevel(ctx, time_end);
+    // スコア計算
+    auto metrics = evaluate_layout_parallel(pos, E, LayoutMetrics::required<ScorePolicyDefault>() | LayoutMetrics::Cross | LayoutMetrics::BadPenetration);
+    double score = metrics.score<ScorePolicyDefault>();
+    std::cout << "score is " << score << '\n';
+    std::cout << "lensum is " << metrics.length << '\n';
+    std::cout << "cross is " << metrics.cross << '\n';
+    std::cout << "penetration is " << metrics.bad_penetration << '\n';
+
+    for (int i = 0; i < N; i++) {
+        ans[i] = {mp.get_process(i), pos[i].first, pos[i].second};
+    }
+    CheckLib::write_csv(path_out, ans);
+}
\ No newline at end of file
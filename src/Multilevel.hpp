@@ -0,0 +1,134 @@
+#ifndef _MULTILEVEL_H_
+#define _MULTILEVEL_H_
+#include "Lib.hpp"
+#include "ProblemContext.hpp"
+#include "Random.hpp"
+#include "SimulatedAnnealing.hpp"
+#include "SearchControl.hpp"
+#include <numeric>
+#include <limits>
+
+/*
+多段階法
+工程をいくつかのパス(x座標の昇順に並んだ工程列)に分け, compress_yでパスの並び順から配置を作る
+1. 1工程1パスから始めて, 辺で繋がっていてx座標の範囲が重ならないパスの組を連結することを繰り返す(粗くする)
+2. 一番粗いパスの集合で並び順を探索
+3. 1段階ずつ細かいパスの集合に並び順を引き継いで, 短時間の山登りで修正
+*/
+
+// パスの集合を1段階粗くする
+// 辺で繋がっていてx座標の範囲が重ならないパスの組を, 間の辺の本数が多い順に貪欲にマッチングして連結する
+// 連結するとき前のパスの末尾から後ろのパスの先頭への辺(鎖)があるものを優先する
+std::vector<std::vector<int>> coarsen_path(const std::vector<std::vector<int>> &P, const std::vector<int> &X, const std::vector<std::pair<int, int>> &E) {
+    int N = X.size(), K = P.size();
+    std::vector<int> pid(N);
+    for (int i = 0; i < K; i++) {
+        for (int v : P[i]) pid[v] = i;
+    }
+    // (前のパス, 後ろのパス) -> (鎖か, 辺の本数)
+    std::map<std::pair<int, int>, std::pair<int, int>> W;
+    for (auto [s, t] : E) {
+        int a = pid[s], b = pid[t];
+        if (a == b) continue;
+        if (X[P[a].back()] < X[P[b][0]]) {
+        } else if (X[P[b].back()] < X[P[a][0]]) {
+            std::swap(a, b);
+        } else {
+            continue;
+        }
+        auto &w = W[{a, b}];
+        if (P[a].back() == s && P[b][0] == t) w.first = 1;
+        w.second++;
+    }
+    std::vector<std::tuple<int, int, int, int>> cand;
+    for (auto [ab, w] : W) {
+        cand.push_back({w.first, w.second, ab.first, ab.second});
+    }
+    std::sort(cand.begin(), cand.end(), std::greater<>());
+    std::vector<int> next(K, -1);
+    std::vector<bool> used(K, false), head(K, true);
+    for (auto [chain, w, a, b] : cand) {
+        if (used[a] || used[b]) continue;
+        used[a] = used[b] = true;
+        next[a] = b;
+        head[b] = false;
+    }
+    std::vector<std::vector<int>> ans;
+    for (int i = 0; i < K; i++) {
+        if (!head[i]) continue;
+        ans.push_back(P[i]);
+        if (next[i] != -1) {
+            ans.back().insert(ans.back().end(), P[next[i]].begin(), P[next[i]].end());
+        }
+    }
+    return ans;
+}
+
+// perm[0, K)の隣接する要素の入れ替えとランダムな2要素の入れ替えによる山登り
+// 並び順はpermに, スコアを返す
+template<typename Policy = ScorePolicyDefault>
+double climb_path_order(const std::vector<std::vector<int>> &P, std::vector<int> &perm, const std::vector<int> &X, const std::vector<std::pair<int, int>> &E, int time_end) {
+    int K = perm.size();
+    ScoreWorkspace ws;
+    double score = calc_score<Policy>(compress_y(P, perm, X, ws), E, ws);
+    if (K <= 1) return score;
+    timer<1>::set();
+    while (timer<1>::elapse() < time_end && !search_stop_requested()) {
+        int a = rng.random_number() % K;
+        int b = (rng.random_number() % 2) ? (a + 1) % K : rng.random_number() % K;
+        if (a == b) continue;
+        std::swap(perm[a], perm[b]);
+        double new_score = calc_score<Policy>(compress_y(P, perm, X, ws), E, ws);
+        if (new_score <= score) {
+            score = new_score;
+            search_report(score);
+        } else {
+            std::swap(perm[a], perm[b]);
+        }
+    }
+    return score;
+}
+
+// 多段階法で配置する
+// coarse_size := パスの本数がこれ以下になったら粗くするのをやめる
+template<typename Policy = ScorePolicyDefault>
+std::vector<std::pair<int, int>> solve_multilevel(const ProblemContext &ctx, int time_end, int coarse_size = 8) {
+    int N = ctx.size();
+    const auto &E = ctx.edges();
+    const auto &X = ctx.min_x();
+
+    // 粗くする
+    std::vector<std::vector<std::vector<int>>> level;
+    level.push_back({});
+    for (int i = 0; i < N; i++) level[0].push_back({i});
+    while (level.back().size() > coarse_size) {
+        auto P = coarsen_path(level.back(), X, E);
+        if (P.size() == level.back().size()) break;
+        level.push_back(P);
+    }
+    int L = level.size();
+    int time_level = std::max(1, time_end / L); // 各段階に使う時間
+
+    // 一番粗い段階で並び順を探索
+    std::vector<int> perm(level[L - 1].size());
+    std::iota(perm.begin(), perm.end(), 0);
+    climb_path_order<Policy>(level[L - 1], perm, X, E, time_level);
+
+    // 並び順を細かい段階に引き継ぐ
+    // 細かいパスは, 含まれる粗いパスの順位, 先頭のx座標の順に並べる
+    for (int l = L - 2; l >= 0; l--) {
+        const auto &C = level[l + 1], &P = level[l];
+        std::vector<int> rank(N);
+        for (int i = 0; i < C.size(); i++) {
+            for (int v : C[perm[i]]) rank[v] = i;
+        }
+        perm.resize(P.size());
+        std::iota(perm.begin(), perm.end(), 0);
+        std::sort(perm.begin(), perm.end(), [&](int a, int b) {
+            return std::make_pair(rank[P[a][0]], X[P[a][0]]) < std::make_pair(rank[P[b][0]], X[P[b][0]]);
+        });
+        climb_path_order<Policy>(P, perm, X, E, time_level);
+    }
+    return compress_y(level[0], perm, X);
+}
+#endif
@@ -0,0 +1,41 @@
+#include "CheckLib.hpp"
+#include "Lib.hpp"
+#include "Engine.hpp"
+#include "ParallelScore.hpp"
+
+// ネットワーク単体法による横軸の座標の決定
+// calc_min_xより辺の横方向の長さの和が小さくなる (縦軸は列ごとに上から詰める)
+int main() {
+    std::string path_in = "../testcase/case1.csv";
+    std::string path_out = "../testcase/case1_ns.csv";
+    assert(CheckLib::is_valid_input(path_in));
+    std::vector<std::pair<int, int>> E;
+    ProcessMap mp;
+    for (auto [s, t] : CheckLib::read_csv(path_in)) {
+        int sid = mp.register_process(s);
+        int tid = mp.register_process(t);
+        E.push_back({sid, tid});
+    }
+
+    E = remove_multiple_edge(E);
+    renumber(mp, E);
+    int N = mp.size();
+    ProblemContext ctx(N, E);
+    auto pos = solve_network_simplex(ctx);
+
+    // スコア計算
+    auto metrics = evaluate_layout_parallel(pos, E, LayoutMetrics::required<ScorePolicyDefault>() | LayoutMetrics::Cross | LayoutMetrics::BadPenetration);
+    double score = metrics.score<ScorePolicyDefault>();
+    std::cout << "score is " << score << '\n';
+    std::cout << "lensum is " << metrics.length << '\n';
+    std::cout << "cross is " << metrics.cross << '\n';
+    std::cout << "penetration is " << metrics.bad_penetration << '\n';
+
+
+    // 答えを作成
+    std::vector<std::tuple<std::string, int, int>> P(N);
+    for (int i = 0; i < N; i++) {
+        P[i] = {mp.get_process(i), pos[i].first, pos[i].second};
+    }
+    CheckLib::write_csv(path_out, P);
+}
\ No newline at end of file
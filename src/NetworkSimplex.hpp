@@ -0,0 +1,306 @@
+#ifndef _NETWORK_SIMPLEX_H_
+#define _NETWORK_SIMPLEX_H_
+#include "Lib.hpp"
+#include "SimulatedAnnealing.hpp"
+#include "SearchControl.hpp"
+#include "ProblemContext.hpp"
+#include <queue>
+#include <deque>
+
+/*
+ネットワーク単体法による横軸の座標の決定 (Gansner et al. のrank assignment)
+辺(s, t)について X[t] - X[s] >= 1 を満たしつつ, sum w(s, t) * (X[t] - X[s]) を最小にする
+1. calc_min_xから始め, 差がちょうど1の辺(tight)だけでできた全域木を作る
+   木に接する辺をslackの小さい順にヒープで持ち, slack最小の辺がtightになるように木をずらして木を伸ばす
+   木全体のずれは1つの値(shift)で持つので, 木の頂点の座標を書き換えるのは木が完成したときの1回だけ
+2. 木の辺のcut valueが負のものを取り除き, 切断を逆向きに跨ぐslack最小の辺を入れる, を繰り返す
+   cut valueが負の辺は, 負になったときにキューに入れておく (取り出すときにまだ負か確かめる)
+   入れ替えのたびに, 取り除いた辺で分かれる2つの側の小さい方だけ, 座標をずらし, 入れた辺の端点を根として親と深さを付け直す
+   cut valueは閉路上の辺だけ求め直す
+3. 弱連結成分ごとに最小の座標を0にそろえる
+calc_min_xと違い, 入次数の少ない工程は後ろの工程に寄せられるので辺が短くなる
+Graph := 隣接リスト(std::vector<std::vector<int>>) または CSRGraph
+X := 1の初期の座標 (calc_min_x), ProblemContextを渡す版は文脈のものを使う
+time_end := 2の制限時間(ms), 負なら制限しない. 時間切れか打ち切りの要求(search_stop_requested)があればその時点の座標を返す (制約は満たす)
+w := 辺の重み (Gの隣接リストの順), 空なら全て1
+optimal := nullptrでなければ, 最適解に達したか(cut valueが負の辺が無くなったか)を入れる
+1は O(M log M), 2の1回の交換は (小さい側の頂点の次数の和 + 閉路上の頂点の次数の和) に比例する
+*/
+template<typename Graph>
+std::vector<int> network_simplex_x(const Graph &G, std::vector<int> X, int time_end = -1, const std::vector<long long> &w = {}, bool *optimal = nullptr) {
+    int N = G.size();
+    std::vector<std::pair<int, int>> es;
+    for (int s = 0; s < N; s++) {
+        for (int t : G[s]) es.push_back({s, t});
+    }
+    int M = es.size();
+    std::vector<long long> W = w;
+    if (W.empty()) W.assign(M, 1);
+    assert(W.size() == M);
+    std::vector<std::vector<int>> inc(N); // 頂点に接する辺の番号
+    for (int i = 0; i < M; i++) {
+        inc[es[i].first].push_back(i);
+        inc[es[i].second].push_back(i);
+    }
+    auto slack = [&](int i) { return X[es[i].second] - X[es[i].first] - 1; };
+    auto other = [&](int i, int v) { return es[i].first ^ es[i].second ^ v; };
+
+    // 1. tightな全域木 (弱連結成分ごとに1本)
+    // 木の頂点の実際の座標は X[v] + shift, 木に接する辺はshiftを除いたslackで
+    // out_q : 木から出る辺 (slackは値 - shift), in_q : 木に入る辺 (slackは値 + shift)
+    using Item = std::pair<int, int>;
+    std::vector<char> in_tree(N, 0), tree_edge(M, 0);
+    std::vector<int> roots, comp(N), nodes, st;
+    for (int r = 0; r < N; r++) {
+        if (in_tree[r]) continue;
+        int c = roots.size();
+        roots.push_back(r);
+        nodes.clear();
+        std::priority_queue<Item, std::vector<Item>, std::greater<Item>> out_q, in_q;
+        int shift = 0;
+        // vと, vから辺がtightな頂点を木に加えていく
+        auto grow = [&](int v) {
+            X[v] -= shift;
+            in_tree[v] = 1;
+            nodes.push_back(v);
+            st.push_back(v);
+            while (!st.empty()) {
+                int u = st.back();
+                st.pop_back();
+                comp[u] = c;
+                for (int i : inc[u]) {
+                    int o = other(i, u);
+                    if (in_tree[o]) continue;
+                    bool out = (es[i].first == u);
+                    int base = (out ? X[o] - X[u] - 1 : X[u] - X[o] - 1);
+                    if ((out ? base - shift : base + shift) != 0) {
+                        (out ? out_q : in_q).push({base, i});
+                        continue;
+                    }
+                    X[o] -= shift;
+                    in_tree[o] = 1;
+                    tree_edge[i] = 1;
+                    nodes.push_back(o);
+                    st.push_back(o);
+                }
+            }
+        };
+        grow(r);
+        while (true) {
+            for (auto q : {&out_q, &in_q}) {
+                while (!q->empty() && in_tree[es[q->top().second].first] && in_tree[es[q->top().second].second]) q->pop();
+            }
+            if (out_q.empty() && in_q.empty()) break;
+            int so = (out_q.empty() ? std::numeric_limits<int>::max() : out_q.top().first - shift);
+            int si = (in_q.empty() ? std::numeric_limits<int>::max() : in_q.top().first + shift);
+            int i;
+            if (so <= si) {
+                // 木を右にずらす
+                i = out_q.top().second;
+                out_q.pop();
+                shift += so;
+            } else {
+                // 木を左にずらす
+                i = in_q.top().second;
+                in_q.pop();
+                shift -= si;
+            }
+            tree_edge[i] = 1;
+            grow(in_tree[es[i].first] ? es[i].second : es[i].first);
+        }
+        for (int v : nodes) X[v] += shift;
+    }
+
+    // 木の親, 親への辺, 深さ, cut value (cut[v] := 辺(v, par[v])のcut value)
+    std::vector<int> par(N, -1), pedge(N, -1), order;
+    std::vector<long long> depth(N, 0);
+    std::vector<long long> cut(N, 0);
+    std::vector<std::vector<int>> tadj(N);
+    for (int i = 0; i < M; i++) {
+        if (!tree_edge[i]) continue;
+        tadj[es[i].first].push_back(i);
+        tadj[es[i].second].push_back(i);
+    }
+    // rを根とする部分木の親と深さを付け直し, 部分木の頂点を根から近い順にresに入れる (par[r], pedge[r], depth[r]はそのまま)
+    auto hang = [&](int r, std::vector<int> &res) {
+        res.clear();
+        res.push_back(r);
+        for (int h = 0; h < res.size(); h++) {
+            int v = res[h];
+            for (int i : tadj[v]) {
+                if (i == pedge[v]) continue;
+                int o = other(i, v);
+                par[o] = v;
+                pedge[o] = i;
+                depth[o] = depth[v] + 1;
+                res.push_back(o);
+            }
+        }
+    };
+    // cut valueが負の辺(の子の側の頂点), 同じ頂点は1つだけ入れる
+    std::deque<int> neg;
+    std::vector<char> queued(N, 0);
+    auto push_neg = [&](int v) {
+        if (queued[v]) return;
+        queued[v] = 1;
+        neg.push_back(v);
+    };
+    // 木の辺(v, par[v])のcut value (vの子のcut valueは求めてあること)
+    auto calc_cut = [&](int v) {
+        int pe = pedge[v];
+        bool tail = (es[pe].first == v);
+        long long c = W[pe];
+        for (int i : inc[v]) {
+            if (i == pe) continue;
+            bool to_head = ((es[i].first == v) == tail);
+            c += to_head ? W[i] : -W[i];
+            if (tree_edge[i]) c += to_head ? -cut[other(i, v)] : cut[other(i, v)];
+        }
+        cut[v] = c;
+        if (c < 0) push_neg(v);
+    };
+
+    std::vector<int> sub;
+    for (int r : roots) {
+        hang(r, sub);
+        for (int k = sub.size() - 1; k > 0; k--) calc_cut(sub[k]);
+    }
+
+    // 2. 木の辺の交換
+    // 取り除く辺は, キューの先頭からcut valueが負の辺をwindow本取り出した中で最も負のもの (残りはキューに戻す)
+    // 取り除く辺で木を2つに分け, 小さい方の側だけを見る (幅優先探索を1頂点ずつ交互に進め, 先に終わった方)
+    // 部分木の側が小さければ部分木を入れる辺の端点aを根にして付け直し, そうでなければ部分木の根vを木の根にし,
+    // 残りを入れる辺の端点bを根にしてaの下に付け直す
+    const int window = 30;
+    timer<3>::set();
+    std::vector<int> mark(N, 0), side[2], cand;
+    int stamp = 0;
+    if (optimal) *optimal = false;
+    while (true) {
+        if ((time_end >= 0 && timer<3>::elapse() >= time_end) || search_stop_requested()) break;
+        cand.clear();
+        while (!neg.empty() && cand.size() < window) {
+            int u = neg.front();
+            neg.pop_front();
+            queued[u] = 0;
+            if (par[u] != -1 && cut[u] < 0) cand.push_back(u);
+        }
+        if (cand.empty()) {
+            if (optimal) *optimal = true;
+            break;
+        }
+        int v = cand[0];
+        for (int u : cand) {
+            if (cut[u] < cut[v]) v = u;
+        }
+        for (int u : cand) {
+            if (u != v) push_neg(u);
+        }
+        int le = pedge[v], p = par[v];
+        // side[0] := 部分木v (mark == stamp), side[1] := 残り (mark == stamp + 1)
+        stamp += 2;
+        side[0].assign(1, v);
+        side[1].assign(1, p);
+        mark[v] = stamp;
+        mark[p] = stamp + 1;
+        int h[2] = {0, 0};
+        while (h[0] < side[0].size() && h[1] < side[1].size()) {
+            for (int k = 0; k < 2; k++) {
+                int u = side[k][h[k]++];
+                for (int i : tadj[u]) {
+                    int o = other(i, u);
+                    if (i == le || mark[o] == stamp + k) continue;
+                    mark[o] = stamp + k;
+                    side[k].push_back(o);
+                }
+            }
+        }
+        int small = (h[0] == side[0].size() ? 0 : 1);
+        auto inside = [&](int u) { return (mark[u] == stamp + small) == (small == 0); }; // 部分木vの側か
+        // 部分木vの外から中へ向かう辺 (vが木の辺の終点の場合は中から外), 小さい側の頂点に接する辺だけ見ればよい
+        bool flip = (es[le].first != v);
+        int enter = -1;
+        for (int u : side[small]) {
+            for (int i : inc[u]) {
+                if (tree_edge[i]) continue;
+                if (flip != inside(es[i].first) || flip == inside(es[i].second)) continue;
+                if (enter == -1 || slack(i) < slack(enter)) enter = i;
+            }
+        }
+        assert(enter != -1);
+        // 小さい側をずらして入れる辺をtightにする (部分木vを右にdeltaずらすのと同じ)
+        int delta = (inside(es[enter].second) ? -slack(enter) : slack(enter));
+        for (int u : side[small]) X[u] += (small == 0 ? delta : -delta);
+        // aは入れる辺の部分木vの側の端点, bは残りの側の端点
+        int a = es[enter].first, b = es[enter].second;
+        if (!inside(a)) std::swap(a, b);
+        // 閉路上の残りの側の頂点の共通祖先 (付け直す前の木で求める)
+        int l = b, q = p;
+        while (l != q) {
+            if (depth[l] < depth[q]) std::swap(l, q);
+            l = par[l];
+        }
+        for (int u : {es[le].first, es[le].second}) tadj[u].erase(std::find(tadj[u].begin(), tadj[u].end(), le));
+        tadj[a].push_back(enter);
+        tadj[b].push_back(enter);
+        tree_edge[le] = 0;
+        tree_edge[enter] = 1;
+        if (small == 0) {
+            par[a] = b;
+            pedge[a] = enter;
+            depth[a] = depth[b] + 1;
+            hang(a, sub);
+            // 閉路はv -> ... -> a -> b -> ... -> l と p -> ... -> l, 下から順にcut valueを求め直す
+            for (int u : {v, p}) {
+                for (; u != l; u = par[u]) calc_cut(u);
+            }
+        } else {
+            // lから元の根までの辺は閉路に含まれないが向きが逆になるので, cut valueを親の側に移す
+            sub.clear();
+            for (int u = l; u != -1; u = par[u]) sub.push_back(u);
+            for (int k = (int)sub.size() - 2; k >= 0; k--) {
+                cut[sub[k + 1]] = cut[sub[k]];
+                if (cut[sub[k + 1]] < 0) push_neg(sub[k + 1]);
+            }
+            par[v] = pedge[v] = -1;
+            par[b] = a;
+            pedge[b] = enter;
+            depth[b] = depth[a] + 1;
+            hang(b, sub);
+            // 閉路は p -> ... -> l -> ... -> b -> a -> ... -> v, 下から順にcut valueを求め直す
+            for (int u = p; u != v; u = par[u]) calc_cut(u);
+        }
+    }
+
+    // 3. 弱連結成分ごとに最小を0にする
+    std::vector<int> mn(roots.size(), std::numeric_limits<int>::max());
+    for (int u = 0; u < N; u++) mn[comp[u]] = std::min(mn[comp[u]], X[u]);
+    for (int u = 0; u < N; u++) X[u] -= mn[comp[u]];
+    return X;
+}
+
+template<typename Graph>
+std::vector<int> network_simplex_x(const Graph &G, int time_end = -1, const std::vector<long long> &w = {}, bool *optimal = nullptr) {
+    return network_simplex_x(G, calc_min_x(G), time_end, w, optimal);
+}
+
+std::vector<int> network_simplex_x(const ProblemContext &ctx, int time_end = -1, const std::vector<long long> &w = {}, bool *optimal = nullptr) {
+    return network_simplex_x(ctx.graph(), ctx.min_x(), time_end, w, optimal);
+}
+
+/*
+横軸も動かす配置で使えるcalc_scoreの下界
+辺の長さは両端の列の差以上で, 他の項は0以上なので, (列の差の和の最小値) * (lengthの重み) を下回らない
+列の差の和の最小値はネットワーク単体法の最適値. 時間内に最適解に達しなかった場合は各辺の差が1以上であることだけを使う
+(calc_lower_boundは横軸をcalc_min_xのまま動かさない手法にしか使えない)
+time_end := ネットワーク単体法の制限時間(ms), 負なら制限しない
+*/
+template<typename Policy = ScorePolicyDefault>
+double calc_lower_bound_free_x(const ProblemContext &ctx, int time_end = -1) {
+    bool optimal;
+    auto X = network_simplex_x(ctx, time_end, {}, &optimal);
+    long long sum = 0;
+    for (auto [s, t] : ctx.edges()) sum += (optimal ? X[t] - X[s] : 1);
+    return Policy::length * sum;
+}
+#endif
@@ -0,0 +1,140 @@
+#ifndef _PARALLEL_SCORE_H_
+#define _PARALLEL_SCORE_H_
+#include "Lib.hpp"
+#include "TaskPool.hpp"
+#include "LayoutSoA.hpp"
+
+/*
+Lib.hppのスコア計算の並列版 (最終的な評価など, 大きな配置を1回だけ評価する用)
+辺ごとの値をTaskPoolのワーカーで計算して配列に入れ, 和は辺の順に1スレッドで取る
+浮動小数点数の足し算の順番が逐次版と同じなので結果はビット単位で一致する
+threads := 1なら呼んだスレッドだけで計算する, それ以外ならTaskPoolを使う (ワーカー数はTaskPool::initで決める)
+*/
+
+namespace ParallelScore {
+    // [0, n)の各iについてf(i)を並列に呼ぶ
+    // grain個ずつまとめてタスクにし, 空いたワーカーが取っていく
+    template<typename F>
+    void parallel_for(int n, int threads, F f, int grain = 64) {
+        if (threads == 1) {
+            for (int i = 0; i < n; i++) f(i);
+            return;
+        }
+        TaskPool::parallel_for(n, f, grain);
+    }
+};
+
+/*
+evaluate_layoutの並列版
+辺ごとの値を並列に求めて辺ごとの配列に入れ, 辺の順に1スレッドで足す
+辺の長さは座標と辺をSoAにしてSIMDでまとめて求める (LayoutSoAKernel::lengths)
+無視できない貫通に関与する長さは逐次版がintに足しこむ(足すたびに切り捨てる)ので, 足す値を辺の順に全て覚えておいて同じ順に足す
+*/
+LayoutMetrics evaluate_layout_parallel(const std::vector<std::pair<int, int>> &pos, const std::vector<std::pair<int, int>> &E, unsigned metrics = LayoutMetrics::All, int threads = 0) {
+    int M = E.size();
+    bool walk = metrics & (LayoutMetrics::BadPenetration | LayoutMetrics::BadPenetrationLength | LayoutMetrics::AllPenetration);
+    ScoreWorkspace ws;
+    if (walk) ws.build(pos, E);
+    std::vector<double> len(M, 0);
+    std::vector<int> bad(M, 0), all(M, 0), cross(M, 0);
+    std::vector<std::vector<double>> bad_len(M);
+    if (metrics & (LayoutMetrics::Length | LayoutMetrics::Naname)) {
+        const int block = 4096;
+        LayoutSoA P(pos);
+        EdgeSoA ES(E);
+        ParallelScore::parallel_for((M + block - 1) / block, threads, [&](int b) {
+            LayoutSoAKernel::lengths(P, ES, b * block, std::min(M, (b + 1) * block), len.data());
+        }, 1);
+    }
+    if (walk || (metrics & LayoutMetrics::Cross)) ParallelScore::parallel_for(M, threads, [&](int i) {
+        auto [s, t] = E[i];
+        auto [sx, sy] = pos[s];
+        auto [tx, ty] = pos[t];
+        int dx = tx - sx;
+        int dy = ty - sy;
+        if (walk) {
+            int g = std::gcd(dx, dy);
+            int ux = dx / g, uy = dy / g;
+            int x = sx + ux, y = sy + uy;
+            int v = s;
+            int dxsum = ux, dysum = uy;
+            while (x != tx) {
+                if (metrics & LayoutMetrics::AllPenetration) all[i] += ws.count(pos, x, y);
+                int next = ws.find(pos, x, y);
+                if (next != -1) {
+                    if (!ws.has_edge(v, next)) {
+                        bad[i]++;
+                        if (metrics & LayoutMetrics::BadPenetrationLength) bad_len[i].push_back(std::sqrt(dxsum * dxsum + dysum * dysum));
+                    }
+                    v = next;
+                }
+                x += ux;
+                y += uy;
+                dxsum += ux;
+                dysum += uy;
+            }
+        }
+        if (metrics & LayoutMetrics::Cross) {
+            for (int j = i + 1; j < M; j++) {
+                auto [c, d] = E[j];
+                auto [cx, cy] = pos[c];
+                auto [ex, ey] = pos[d];
+                assert(sx != tx);
+                assert(cx != ex);
+                double s1 = double(ty - sy) / (tx - sx);
+                double s2 = double(ey - cy) / (ex - cx);
+                if (s1 != s2) {
+                    double cross_x = (s1 * sx - sy - s2 * cx + cy) / (s1 - s2);
+                    if (sx < cross_x && cross_x < tx && cx < cross_x && cross_x < ex) cross[i]++;
+                }
+            }
+        }
+    }, 16);
+    LayoutMetrics res;
+    for (int i = 0; i < M; i++) {
+        if (metrics & LayoutMetrics::Length) res.length += len[i];
+        if ((metrics & LayoutMetrics::Naname) && pos[E[i].second].second != pos[E[i].first].second) res.naname += len[i];
+        if (metrics & LayoutMetrics::BadPenetration) res.bad_penetration += bad[i];
+        for (double l : bad_len[i]) res.bad_penetration_length += l;
+        res.all_penetration += all[i];
+        res.cross += cross[i];
+    }
+    return res;
+}
+
+// 辺の長さの総和を返す
+double sum_edge_length_parallel(const std::vector<std::pair<int, int>> &pos, const std::vector<std::pair<int, int>> &E, int threads = 0) {
+    return evaluate_layout_parallel(pos, E, LayoutMetrics::Length, threads).length;
+}
+
+// 斜めの辺の長さの総和
+double sum_edge_length_naname_parallel(const std::vector<std::pair<int, int>> &pos, const std::vector<std::pair<int, int>> &E, int threads = 0) {
+    return evaluate_layout_parallel(pos, E, LayoutMetrics::Naname, threads).naname;
+}
+
+// 無視できない貫通を数える
+int count_bad_penetration_parallel(const std::vector<std::pair<int, int>> &pos, const std::vector<std::pair<int, int>> &E, int threads = 0) {
+    return evaluate_layout_parallel(pos, E, LayoutMetrics::BadPenetration, threads).bad_penetration;
+}
+
+// 無視できない貫通に関与する辺の長さの和
+int sum_edge_length_bad_penetration_parallel(const std::vector<std::pair<int, int>> &pos, const std::vector<std::pair<int, int>> &E, int threads = 0) {
+    return evaluate_layout_parallel(pos, E, LayoutMetrics::BadPenetrationLength, threads).bad_penetration_length;
+}
+
+// 辺が交差する回数
+int count_edge_cross_parallel(const std::vector<std::pair<int, int>> &pos, const std::vector<std::pair<int, int>> &E, int threads = 0) {
+    return evaluate_layout_parallel(pos, E, LayoutMetrics::Cross, threads).cross;
+}
+
+// calc_scoreの並列版, 項を足す順番はcalc_scoreと同じ
+template<typename Policy>
+double calc_score_parallel(const std::vector<std::pair<int, int>> &pos, const std::vector<std::pair<int, int>> &E, int threads = 0) {
+    LayoutMetrics m = evaluate_layout_parallel(pos, E, LayoutMetrics::required<Policy>(), threads);
+    return m.score<Policy>();
+}
+
+double calc_score_parallel(const std::vector<std::pair<int, int>> &pos, const std::vector<std::pair<int, int>> &E, int threads = 0) {
+    return calc_score_parallel<ScorePolicyDefault>(pos, E, threads);
+}
+#endif
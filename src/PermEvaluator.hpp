@@ -0,0 +1,207 @@
+#ifndef _PERM_EVALUATOR_H_
+#define _PERM_EVALUATOR_H_
+#include "Lib.hpp"
+#include "ParallelScore.hpp"
+#include "ScoreCache.hpp"
+
+/*
+パスの並び順(perm)をまとめて評価する
+compress_y(P, perm, X) の配置の calc_score<Policy> を返す (結果はビット単位で一致する)
+横軸は並び順によらずXなので, 辺ごとのx方向の差, 辺の有無, パスのx座標の範囲は最初に1回だけ求めておく
+貫通の判定で格子点にある工程を探すときは, 全工程を見る代わりにハッシュ表を引く
+作業用の配列はTaskPoolのスレッドごとの作業用メモリ(Arena)から取るので, 評価のたびにヒープから確保しない
+複数の並び順を渡すと並列に評価する
+*/
+template<typename Policy = ScorePolicyDefault>
+struct PermEvaluator {
+    int N, K, M;
+    const std::vector<std::vector<int>> &P;
+    const std::vector<int> &X;
+    const std::vector<std::pair<int, int>> &E;
+    int threads;
+    std::vector<int> lx, rx; // パスの左端と右端のx座標
+    std::vector<int> off, adj; // 工程ごとの行き先 (昇順)
+    int H; // ハッシュ表の大きさ (2の冪)
+
+    // 1回の評価で使う作業用の配列
+    struct Workspace {
+        int *y, *mark;
+        char *used;
+        long long *key;
+        int *val;
+    };
+
+    // threads := 使うスレッド数, 0ならハードウェアのスレッド数
+    PermEvaluator(const std::vector<std::vector<int>> &_P, const std::vector<int> &_X, const std::vector<std::pair<int, int>> &_E, int _threads = 0)
+        : N(_X.size()), K(_P.size()), M(_E.size()), P(_P), X(_X), E(_E), threads(_threads) {
+        lx.resize(K);
+        rx.resize(K);
+        for (int i = 0; i < K; i++) {
+            lx[i] = X[P[i][0]];
+            rx[i] = X[P[i].back()];
+        }
+        off.assign(N + 1, 0);
+        for (auto [s, t] : E) off[s + 1]++;
+        for (int i = 0; i < N; i++) off[i + 1] += off[i];
+        adj.resize(M);
+        std::vector<int> cur(off.begin(), off.end() - 1);
+        for (auto [s, t] : E) adj[cur[s]++] = t;
+        for (int i = 0; i < N; i++) std::sort(adj.begin() + off[i], adj.begin() + off[i + 1]);
+        H = 1;
+        while (H < 2 * N) H *= 2;
+    }
+
+    bool has_edge(int s, int t) const {
+        return std::binary_search(adj.begin() + off[s], adj.begin() + off[s + 1], t);
+    }
+
+    Workspace workspace(TaskPool::Arena &arena) const {
+        Workspace ws;
+        ws.y = arena.alloc<int>(N);
+        ws.mark = arena.alloc<int>(N);
+        ws.used = arena.alloc<char>(N);
+        ws.key = arena.alloc<long long>(H);
+        ws.val = arena.alloc<int>(H);
+        return ws;
+    }
+
+    // compress_yと同じ方法で各工程のy座標を決める
+    void assign_y(const std::vector<int> &perm, Workspace &ws) const {
+        std::fill(ws.used, ws.used + N, 0);
+        int l = 0, y = 0;
+        while (l < K) {
+            int r = l, nmark = 0;
+            while (r < K) {
+                bool ok = true;
+                for (int j = lx[perm[r]]; j <= rx[perm[r]]; j++) {
+                    if (ws.used[j]) {
+                        ok = false;
+                        break;
+                    }
+                    ws.used[j] = 1;
+                    ws.mark[nmark++] = j;
+                }
+                if (!ok) break;
+                r++;
+            }
+            for (int i = l; i < r; i++) {
+                for (int v : P[perm[i]]) ws.y[v] = y;
+            }
+            for (int i = 0; i < nmark; i++) ws.used[ws.mark[i]] = 0;
+            y++;
+            l = r;
+        }
+    }
+
+    long long cell(int x, int y) const {
+        return (long long)x * (K + 1) + y;
+    }
+
+    // 格子点(x, y)にある工程, 無ければ-1
+    int find(const Workspace &ws, int x, int y) const {
+        long long k = cell(x, y);
+        for (int h = Zobrist::mix(k) & (H - 1);; h = (h + 1) & (H - 1)) {
+            if (ws.key[h] == k) return ws.val[h];
+            if (ws.key[h] == -1) return -1;
+        }
+    }
+
+    void build_table(Workspace &ws) const {
+        std::fill(ws.key, ws.key + H, -1);
+        for (int v = 0; v < N; v++) {
+            long long k = cell(X[v], ws.y[v]);
+            int h = Zobrist::mix(k) & (H - 1);
+            while (ws.key[h] != -1) h = (h + 1) & (H - 1);
+            ws.key[h] = k;
+            ws.val[h] = v;
+        }
+    }
+
+    // 1つの並び順を評価する
+    double operator ()(const std::vector<int> &perm) const {
+        TaskPool::ArenaScope scope(TaskPool::arena());
+        Workspace ws = workspace(TaskPool::arena());
+        assign_y(perm, ws);
+        const auto &Y = ws.y;
+        double ans = 0;
+        if constexpr (Policy::length != 0) {
+            double sum = 0;
+            for (auto [s, t] : E) {
+                int dx = X[t] - X[s];
+                int dy = Y[t] - Y[s];
+                sum += std::sqrt(dx * dx + dy * dy);
+            }
+            ans += Policy::length * sum;
+        }
+        if constexpr (Policy::naname != 0) {
+            double sum = 0;
+            for (auto [s, t] : E) {
+                int dx = X[t] - X[s];
+                int dy = Y[t] - Y[s];
+                if (dy != 0) sum += std::sqrt(dx * dx + dy * dy);
+            }
+            ans += Policy::naname * sum;
+        }
+        if constexpr (Policy::penetration != 0) {
+            build_table(ws);
+            int sum = 0;
+            for (auto [s, t] : E) {
+                int dx = X[t] - X[s];
+                int dy = Y[t] - Y[s];
+                int g = std::gcd(dx, dy);
+                dx /= g;
+                dy /= g;
+                int x = X[s] + dx, y = Y[s] + dy;
+                int v = s;
+                int dxsum = dx, dysum = dy;
+                while (x != X[t]) {
+                    int next = find(ws, x, y);
+                    if (next != -1) {
+                        if (!has_edge(v, next)) {
+                            sum += std::sqrt(dxsum * dxsum + dysum * dysum);
+                        }
+                        v = next;
+                    }
+                    x += dx;
+                    y += dy;
+                    dxsum += dx;
+                    dysum += dy;
+                }
+            }
+            ans += Policy::penetration * sum;
+        }
+        if constexpr (Policy::cross != 0) {
+            int cnt = 0;
+            for (int i = 0; i < M; i++) {
+                auto [a, b] = E[i];
+                int ax = X[a], ay = Y[a], bx = X[b], by = Y[b];
+                for (int j = i + 1; j < M; j++) {
+                    auto [c, d] = E[j];
+                    int cx = X[c], cy = Y[c], dx = X[d], dy = Y[d];
+                    double s1 = double(by - ay) / (bx - ax);
+                    double s2 = double(dy - cy) / (dx - cx);
+                    if (s1 != s2) {
+                        double cross_x = (s1 * ax - ay - s2 * cx + cy) / (s1 - s2);
+                        if (ax < cross_x && cross_x < bx && cx < cross_x && cross_x < dx) cnt++;
+                    }
+                }
+            }
+            ans += Policy::cross * cnt;
+        }
+        return ans;
+    }
+
+    // 複数の並び順を並列に評価して, (スコアの列, スコアが最小の添字) を返す
+    // 最小が複数あれば添字が最小のもの
+    std::pair<std::vector<double>, int> operator ()(const std::vector<std::vector<int>> &perms) const {
+        int B = perms.size();
+        std::vector<double> score(B);
+        ParallelScore::parallel_for(B, threads, [&](int i) { score[i] = (*this)(perms[i]); }, 16);
+        int best = 0;
+        for (int i = 1; i < B; i++) {
+            if (score[i] < score[best]) best = i;
+        }
+        return {score, best};
+    }
+};
+#endif
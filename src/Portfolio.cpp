@@ -0,0 +1,45 @@
+#include "CheckLib.hpp"
+#include "Lib.hpp"
+#include "Portfolio.hpp"
+#include "ParallelScore.hpp"
+
+// 複数の手法を同時に動かして一番良い配置を採用する
+int main() {
+    std::string path_in = "../testcase/case1.csv";
+    std::string path_out = "../testcase/case1_pf.csv";
+    std::vector<std::string> engines = {"perm", "lp", "cl", "ml", "bccl"};
+    int time_end = 2000;
+    bool stop_losers = true; // 負けている手法を途中で打ち切るか
+
+    assert(CheckLib::is_valid_input(path_in));
+    std::vector<std::pair<int, int>> E;
+    ProcessMap mp;
+    for (auto [s, t] : CheckLib::read_csv(path_in)) {
+        int sid = mp.register_process(s);
+        int tid = mp.register_process(t);
+        E.push_back({sid, tid});
+    }
+    E = remove_multiple_edge(E);
+    renumber(mp, E);
+    int N = mp.size();
+
+    portfolio<> pf(N, E);
+    auto pos = pf(engines, time_end, stop_losers);
+    for (auto &r : pf.run) {
+        std::cout << r.engine << " (seed " << r.seed << ") " << r.score << (r.stopped ? " stopped" : "") << '\n';
+    }
+
+    // スコア計算
+    auto metrics = evaluate_layout_parallel(pos, E, LayoutMetrics::required<ScorePolicyDefault>() | LayoutMetrics::Cross | LayoutMetrics::BadPenetration);
+    double score = metrics.score<ScorePolicyDefault>();
+    std::cout << "score is " << score << '\n';
+    std::cout << "lensum is " << metrics.length << '\n';
+    std::cout << "cross is " << metrics.cross << '\n';
+    std::cout << "penetration is " << metrics.bad_penetration << '\n';
+
+    std::vector<std::tuple<std::string, int, int>> ans(N);
+    for (int i = 0; i < N; i++) {
+        ans[i] = {mp.get_process(i), pos[i].first, pos[i].second};
+    }
+    CheckLib::write_csv(path_out, ans);
+}
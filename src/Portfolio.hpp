@@ -0,0 +1,112 @@
+#ifndef _PORTFOLIO_H_
+#define _PORTFOLIO_H_
+#include "Engine.hpp"
+#include "SearchControl.hpp"
+#include "TaskPool.hpp"
+#include <thread>
+#include <mutex>
+#include <memory>
+
+/*
+複数の手法をTaskPoolのタスクとして同時に動かし, 共通の制限時間の後にcalc_scoreが最小の配置を採用する
+probe_ms経過した時点で, 最良の手法よりスコアが(1 + margin)倍以上悪い手法を打ち切る (stop_losers := trueの場合)
+打ち切って空いたワーカーは, 残った手法が積んだタスク(lpのレプリカなど)を実行する
+ワーカー数より手法が多い場合, 後の手法は空くまで待ち, 残りの時間だけ動かす
+*/
+
+// 1回の実行の結果
+struct PortfolioRun {
+    std::string engine;
+    int seed;
+    bool stopped = false; // 途中で打ち切ったか
+    bool done = false; // 終了したか
+    double score = std::numeric_limits<double>::max(); // 最終的な配置のcalc_score
+    std::vector<std::pair<int, int>> pos;
+
+    PortfolioRun(const std::string &_engine, int _seed) : engine(_engine), seed(_seed) {}
+};
+
+template<typename Policy = ScorePolicyDefault>
+struct portfolio {
+    int N;
+    const std::vector<std::pair<int, int>> &E;
+    ProblemContext ctx; // 全ての手法で共有する (列やパスへの分解は1回だけ計算する)
+    std::vector<std::unique_ptr<SearchControl>> control;
+    std::vector<PortfolioRun> run;
+    TaskPool::TaskGroup group;
+    std::mutex mtx;
+    long long start; // 開始時刻(ms)
+    int sample = 0, resync = 1000; // 山登り法の受理の判定に使う辺の標本 (Engine.hppのsolveを参照)
+
+    portfolio(int _N, const std::vector<std::pair<int, int>> &_E) : N(_N), E(_E), ctx(_N, _E) {}
+
+    // engineをseedで開始から制限時間time_end(ms)まで動かすタスクを積む
+    void launch(const std::string &engine, int seed, int time_end) {
+        int id;
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            id = run.size();
+            run.emplace_back(engine, seed);
+            control.emplace_back(new SearchControl());
+        }
+        SearchControl *c = control[id].get();
+        group.run([this, id, c, engine, seed, time_end]() {
+            search_control = c;
+            // ワーカーのrngを借りるので, 終わったら元の状態に戻す
+            auto saved = rng;
+            rng.set_seed(seed);
+            int rest = std::max<long long>(0, time_end - (timems() - start));
+            auto pos = solve<Policy>(engine, ctx, rest, sample, resync);
+            rng = saved;
+            double score = calc_score<Policy>(pos, E);
+            search_report(score);
+            std::lock_guard<std::mutex> lock(mtx);
+            run[id].pos = pos;
+            run[id].score = score;
+            run[id].done = true;
+        });
+    }
+
+    // 途中経過のスコア
+    double current(int id) {
+        return control[id]->best.load();
+    }
+
+    /*
+    engines := 使う手法の名前 (Engine.hppのsolveを参照)
+    time_end := 全体の制限時間(ms)
+    probe_ms := 打ち切りを判定する時刻(ms)
+    */
+    std::vector<std::pair<int, int>> operator ()(const std::vector<std::string> &engines, int time_end, bool stop_losers = true, int probe_ms = 300, double margin = 0.05) {
+        start = timems();
+        for (int i = 0; i < engines.size(); i++) {
+            assert(is_engine(engines[i]));
+            launch(engines[i], 1234 + i, time_end);
+        }
+        int K = engines.size();
+        if (stop_losers && probe_ms < time_end) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(probe_ms));
+            int leader = 0;
+            for (int i = 1; i < K; i++) {
+                if (current(i) < current(leader)) leader = i;
+            }
+            // 途中経過をまだ報告していない手法は判定しない
+            for (int i = 0; i < K; i++) {
+                if (i == leader || current(i) == std::numeric_limits<double>::max()) continue;
+                if (current(i) > current(leader) * (1 + margin)) {
+                    control[i]->stop = true;
+                    std::lock_guard<std::mutex> lock(mtx);
+                    if (!run[i].done) run[i].stopped = true;
+                }
+            }
+        }
+        group.wait();
+        // 打ち切られた手法もそれまでの最良の配置を返している
+        int best = 0;
+        for (int i = 1; i < run.size(); i++) {
+            if (run[i].score < run[best].score) best = i;
+        }
+        return run[best].pos;
+    }
+};
+#endif
@@ -0,0 +1,89 @@
+#ifndef _PROBLEM_CONTEXT_H_
+#define _PROBLEM_CONTEXT_H_
+#include "Lib.hpp"
+#include <mutex>
+
+/*
+1つの入力 (工程数と, 多重辺を除いた辺集合) から決まる構造をまとめたもの
+各手法がそれぞれ同じものを計算し直さないように, 最初に使われたときに1回だけ計算して覚えておく
+作った後は辺集合を変えないので, 1つの文脈を複数のスレッド(Portfolioの各手法など)から同時に使ってよい
+  graph()             : 隣接リスト (graph().rev(v) で逆向き)
+  topological_order() : トポロジカル順 (topological_order)
+  min_x()             : 各工程の列 (calc_min_x)
+  column_count()      : 列ごとの工程数
+  columns()           : 列ごとの工程 (番号の昇順)
+  long_paths()        : パスへの分解 (decompose_long_path)
+*/
+class ProblemContext {
+    int N;
+    std::vector<std::pair<int, int>> E;
+    CSRGraph G;
+    mutable std::once_flag order_once, column_once, path_once;
+    mutable std::vector<int> ord, X, xcnt;
+    mutable std::vector<std::vector<int>> col, P;
+
+  public:
+    ProblemContext(int _N, std::vector<std::pair<int, int>> _E) : N(_N), E(std::move(_E)), G(_N, E) {}
+    ProblemContext(const ProblemContext &) = delete;
+
+    // 工程数
+    int size() const {
+        return N;
+    }
+
+    const std::vector<std::pair<int, int>> &edges() const {
+        return E;
+    }
+
+    const CSRGraph &graph() const {
+        return G;
+    }
+
+    const std::vector<int> &topological_order() const {
+        std::call_once(order_once, [&]() {
+            ord = ::topological_order(G);
+            X = calc_min_x(G, ord);
+        });
+        return ord;
+    }
+
+    bool is_DAG() const {
+        return topological_order().size() == N;
+    }
+
+    const std::vector<int> &min_x() const {
+        topological_order();
+        return X;
+    }
+
+    const std::vector<int> &column_count() const {
+        std::call_once(column_once, [&]() {
+            const auto &X = min_x();
+            int L = (N == 0 ? 0 : *std::max_element(X.begin(), X.end()) + 1);
+            xcnt.assign(L, 0);
+            col.assign(L, {});
+            for (int v = 0; v < N; v++) {
+                xcnt[X[v]]++;
+                col[X[v]].push_back(v);
+            }
+        });
+        return xcnt;
+    }
+
+    const std::vector<std::vector<int>> &columns() const {
+        column_count();
+        return col;
+    }
+
+    const std::vector<std::vector<int>> &long_paths() const {
+        std::call_once(path_once, [&]() { P = decompose_long_path(G); });
+        return P;
+    }
+};
+
+// calc_lower_boundの文脈を使う版 (列は文脈のものを使う)
+template<typename Policy = ScorePolicyDefault>
+double calc_lower_bound(const ProblemContext &ctx) {
+    return calc_lower_bound<Policy>(ctx.graph(), ctx.min_x());
+}
+#endif
@@ -0,0 +1,97 @@
+#ifndef _SCORE_CACHE_H_
+#define _SCORE_CACHE_H_
+#include <vector>
+#include <utility>
+#include <cstdint>
+
+/*
+同じ配置を何度も評価しないためのスコアのキャッシュ(置換表)
+配置は (パスの並び順perm, x座標X) のZobristハッシュで識別する
+  key = xor_i h(perm, i, perm[i]) ^ xor_v h(x, v, X[v])
+なので1か所の変更はその項をxorし直すだけでO(1)で更新できる
+*/
+
+namespace Zobrist {
+    // splitmix64
+    uint64_t mix(uint64_t x) {
+        x += 0x9e3779b97f4a7c15ULL;
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+        return x ^ (x >> 31);
+    }
+
+    // permのi番目がpである項
+    uint64_t perm_term(int i, int p) {
+        return mix(((uint64_t)(uint32_t)i << 32 | (uint32_t)p) ^ 0x5045524dULL);
+    }
+
+    // 工程vのx座標がxである項
+    uint64_t x_term(int v, int x) {
+        return mix(mix((uint64_t)(uint32_t)v << 32 | (uint32_t)x) ^ 0x58ULL);
+    }
+
+    uint64_t perm_key(const std::vector<int> &perm) {
+        uint64_t key = 0;
+        for (int i = 0; i < perm.size(); i++) key ^= perm_term(i, perm[i]);
+        return key;
+    }
+
+    uint64_t x_key(const std::vector<int> &X) {
+        uint64_t key = 0;
+        for (int v = 0; v < X.size(); v++) key ^= x_term(v, X[v]);
+        return key;
+    }
+
+    // 辺集合の項 (辺の順番によらない). チェックポイントが同じ入力のものかの確認に使う
+    uint64_t edges_key(const std::vector<std::pair<int, int>> &E) {
+        uint64_t key = mix(E.size() ^ 0x45ULL);
+        for (auto [s, t] : E) key ^= mix(mix((uint64_t)(uint32_t)s << 32 | (uint32_t)t) ^ 0x45ULL);
+        return key;
+    }
+};
+
+// 大きさ2^log_sizeの直接写像のキャッシュ
+// 衝突した場合は新しい方で上書きする
+template<typename Score>
+struct ScoreCache {
+  private:
+    int mask;
+    std::vector<uint64_t> _key; // 0は空を表す
+    std::vector<Score> _score;
+
+  public:
+    long long hit = 0, miss = 0;
+
+    ScoreCache(int log_size = 16) : mask((1 << log_size) - 1), _key(1 << log_size, 0), _score(1 << log_size) {}
+
+    // keyのスコアが登録されていればscoreに入れてtrueを返す
+    bool find(uint64_t key, Score &score) {
+        if (key == 0) key = 1;
+        int i = key & mask;
+        if (_key[i] == key) {
+            hit++;
+            score = _score[i];
+            return true;
+        }
+        miss++;
+        return false;
+    }
+
+    void insert(uint64_t key, const Score &score) {
+        if (key == 0) key = 1;
+        int i = key & mask;
+        _key[i] = key;
+        _score[i] = score;
+    }
+
+    // キャッシュを引いて無ければf()で計算して登録する
+    template<typename F>
+    Score get(uint64_t key, F f) {
+        Score score;
+        if (find(key, score)) return score;
+        score = f();
+        insert(key, score);
+        return score;
+    }
+};
+#endif
@@ -0,0 +1,62 @@
+#ifndef _SEARCH_CONTROL_H_
+#define _SEARCH_CONTROL_H_
+#include <atomic>
+#include <limits>
+#include <chrono>
+
+/*
+別スレッドで動いている探索を外から打ち切ったり, 途中経過のスコアを見たりするための情報
+探索を動かすスレッドで search_control にポインタをセットしておくと,
+各手法は時間切れの判定のたびに stop を見て, 最良スコアが更新されるたびに best を更新する
+セットしていない場合は何もしない
+
+打ち切り条件 (探索を始める前に設定する)
+target        : bestがこれ以下になったら打ち切る
+lower_bound   : スコアの下界 (横軸をcalc_min_xのまま動かさない手法はcalc_lower_bound, 動かす手法はcalc_lower_bound_free_x)
+gap           : (best - lower_bound) / lower_bound がこれ以下になったら打ち切る, 負なら使わない
+stagnation_ms : この時間(ms)bestが更新されなければ打ち切る, 0以下なら使わない
+*/
+struct SearchControl {
+    std::atomic<bool> stop{false}; // trueにすると探索を打ち切る
+    std::atomic<double> best{std::numeric_limits<double>::max()}; // これまでの最良スコア
+    double target = -std::numeric_limits<double>::max();
+    double lower_bound = 0;
+    double gap = -1;
+    int stagnation_ms = 0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::atomic<long long> last_improve{0}; // 最後にbestが更新された時刻(startからのms)
+
+    long long elapse() const {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // 打ち切り条件を満たしているか
+    bool satisfied() const {
+        double b = best.load(std::memory_order_relaxed);
+        if (b <= target) return true;
+        if (gap >= 0 && b <= lower_bound * (1 + gap)) return true;
+        if (stagnation_ms > 0 && elapse() - last_improve.load(std::memory_order_relaxed) >= stagnation_ms) return true;
+        return false;
+    }
+};
+
+thread_local SearchControl *search_control = nullptr;
+
+// 打ち切りが要求されているか (外からの要求か, 打ち切り条件を満たしたか)
+bool search_stop_requested() {
+    if (search_control == nullptr) return false;
+    return search_control->stop.load(std::memory_order_relaxed) || search_control->satisfied();
+}
+
+// 最良スコアを報告する
+void search_report(double score) {
+    if (search_control == nullptr) return;
+    double cur = search_control->best.load(std::memory_order_relaxed);
+    while (score < cur) {
+        if (search_control->best.compare_exchange_weak(cur, score)) {
+            search_control->last_improve = search_control->elapse();
+            break;
+        }
+    }
+}
+#endif
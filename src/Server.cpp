@@ -0,0 +1,99 @@
+#include "Service.hpp"
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <csignal>
+#include <cerrno>
+
+// ファイルディスクリプタから1行ずつ読む
+struct FdLineReader {
+    int fd;
+    std::string buf;
+    size_t head = 0;
+
+    FdLineReader(int _fd) : fd(_fd) {}
+
+    bool operator ()(std::string &s) {
+        while (true) {
+            size_t p = buf.find('\n', head);
+            if (p != std::string::npos) {
+                s = buf.substr(head, p - head);
+                head = p + 1;
+                return true;
+            }
+            buf.erase(0, head);
+            head = 0;
+            char tmp[4096];
+            ssize_t n = read(fd, tmp, sizeof(tmp));
+            if (n == -1 && errno == EINTR) continue;
+            if (n <= 0) {
+                if (buf.empty()) return false;
+                s = buf;
+                buf.clear();
+                return true;
+            }
+            buf.append(tmp, n);
+        }
+    }
+};
+
+// 接続1つ分, レスポンスを全て書き終わって参照が無くなったら閉じる
+struct Connection {
+    int fd;
+    std::mutex mtx;
+    Connection(int _fd) : fd(_fd) {}
+    ~Connection() {
+        close(fd);
+    }
+    // 相手が切断していたら書くのをやめる (MSG_NOSIGNALでSIGPIPEを出さない)
+    void write_frame(const std::string &s) {
+        std::lock_guard<std::mutex> lock(mtx);
+        size_t done = 0;
+        while (done < s.size()) {
+            ssize_t n = send(fd, s.data() + done, s.size() - done, MSG_NOSIGNAL);
+            if (n == -1 && errno == EINTR) continue;
+            if (n <= 0) return;
+            done += n;
+        }
+    }
+};
+
+// 引数なし: 標準入力からリクエストを読み, 標準出力にレスポンスを書く
+// 引数あり: そのパスのUnixドメインソケットで接続を待ち, 接続ごとにリクエストを読んで同じ接続に返す
+// 書き込み先が閉じられてもSIGPIPEで終了しないようにする (書き込みが失敗するだけ)
+int main(int argc, char **argv) {
+    std::signal(SIGPIPE, SIG_IGN);
+    LayoutService service;
+    if (argc < 2) {
+        std::mutex mtx;
+        auto read_line = [](std::string &s) -> bool { return (bool)std::getline(std::cin, s); };
+        auto write = [&](const std::string &s) {
+            std::lock_guard<std::mutex> lock(mtx);
+            std::cout << s << std::flush;
+        };
+        service.serve(read_line, write);
+        return 0; // serviceのデストラクタで処理中のリクエストを待つ
+    }
+
+    std::string path = argv[1];
+    int sock = socket(AF_UNIX, SOCK_STREAM, 0);
+    assert(sock != -1);
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    assert(path.size() < sizeof(addr.sun_path));
+    std::copy(path.begin(), path.end(), addr.sun_path);
+    unlink(path.c_str());
+    if (bind(sock, (sockaddr *)&addr, sizeof(addr)) == -1 || listen(sock, 16) == -1) {
+        std::cerr << "cannot listen on " << path << '\n';
+        return 1;
+    }
+    while (true) {
+        int fd = accept(sock, nullptr, nullptr);
+        if (fd == -1) continue;
+        auto conn = std::make_shared<Connection>(fd);
+        std::thread([&service, conn]() {
+            FdLineReader reader(conn->fd);
+            service.serve(std::ref(reader), [conn](const std::string &s) { conn->write_frame(s); });
+        }).detach();
+    }
+}
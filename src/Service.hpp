@@ -0,0 +1,185 @@
+#ifndef _SERVICE_H_
+#define _SERVICE_H_
+#include "CheckLib.hpp"
+#include "Lib.hpp"
+#include "Engine.hpp"
+#include "TaskPool.hpp"
+#include <functional>
+#include <memory>
+#include <sstream>
+
+/*
+常駐して配置のリクエストを処理する
+リクエストと標本の辺数とresyncは省略でき, 山登り法の受理の判定に使う (Engine.hppのsolveを参照, 省略時は0と1000)
+レスポンスは行単位のテキストで, 1つのリクエストは次の形式
+  LAYOUT (id) (手法名) (制限時間ms) (辺数M) [(標本の辺数) [(resync)]]
+  (辺の始点),(辺の終点)    ... M行
+標本の辺数とresyncは省略でき, 山登り法の受理の判定に使う (Engine.hppのsolveを参照, 省略時は0と1000)
+レスポンスは
+  RESULT (id) (工程数N) (score) (lensum) (cross) (penetration)
+  (工程名),(x座標),(y座標) ... N行
+  END (id)
+または
+  ERROR (id) (メッセージ)
+複数のリクエストをTaskPoolで並列に処理するので, レスポンスの順番はリクエストの順番と異なることがある
+*/
+
+struct LayoutRequest {
+    std::string id, engine;
+    int time_end = 0;
+    int sample = 0, resync = 1000;
+    std::vector<std::pair<std::string, std::string>> E;
+};
+
+// 1行ずつ読む関数 (読めなくなったらfalse)
+using LineReader = std::function<bool(std::string &)>;
+// レスポンス1つ分をまとめて書き出す関数
+using FrameWriter = std::function<void(const std::string &)>;
+
+namespace Service {
+    // リクエストを1つ読む
+    // 入力が終わったら false, 形式が正しくない場合は err にメッセージを入れて true を返す
+    // ヘッダが正しくなくても辺数Mが読めれば続くM行を読み飛ばす
+    // Mが読めなければ続きの区切りが分からないので, 次のLAYOUTで始まる行まで読み飛ばしてnextに入れておく
+    // next := 前の呼び出しで読み飛ばした先のヘッダ行 (無ければ空). 最初は空にして, 同じ入力では同じものを渡す
+    bool read_request(LineReader read_line, LayoutRequest &req, std::string &err, std::string &next) {
+        std::string s;
+        err.clear();
+        if (!next.empty()) {
+            s = std::move(next);
+            next.clear();
+        } else {
+            while (true) {
+                if (!read_line(s)) return false;
+                CheckLib::remove_suffix_endl(s);
+                if (!s.empty()) break;
+            }
+        }
+        std::stringstream ss(s);
+        std::string tag, time_end, M_str, sample, resync;
+        int M = -1;
+        req = LayoutRequest();
+        ss >> tag >> req.id >> req.engine >> time_end >> M_str >> sample >> resync;
+        auto to_int = [](const std::string &t, int &v) {
+            std::stringstream ts(t);
+            return (bool)(ts >> v) && ts.eof();
+        };
+        if (tag != "LAYOUT" || !to_int(M_str, M) || M < 0) {
+            err = "invalid header";
+            while (read_line(s)) {
+                CheckLib::remove_suffix_endl(s);
+                std::stringstream ts(s);
+                std::string t;
+                if (ts >> t && t == "LAYOUT") {
+                    next = s;
+                    break;
+                }
+            }
+            return true;
+        }
+        if (!to_int(time_end, req.time_end)) err = "invalid header";
+        if (!sample.empty() && (!to_int(sample, req.sample) || req.sample < 0)) err = "invalid header";
+        if (!resync.empty() && (!to_int(resync, req.resync) || req.resync <= 0)) err = "invalid header";
+        for (int i = 0; i < M; i++) {
+            if (!read_line(s)) {
+                err = "unexpected end of input";
+                return false;
+            }
+            CheckLib::remove_suffix_endl(s);
+            size_t pos_comma = s.rfind(',');
+            if (pos_comma == std::string::npos) {
+                err = "invalid edge";
+                continue;
+            }
+            req.E.push_back({s.substr(0, pos_comma), s.substr(pos_comma + 1)});
+        }
+        if (err.empty() && !is_engine(req.engine)) err = "unknown engine";
+        return true;
+    }
+
+    std::string error_frame(const std::string &id, const std::string &msg) {
+        return "ERROR " + (id.empty() ? "-" : id) + " " + msg + "\n";
+    }
+
+    // リクエストごとに確保し直さないように使い回す作業領域 (ワーカーごとに1つ)
+    struct Workspace {
+        ProcessMap mp;
+        std::vector<std::pair<int, int>> E;
+        ScoreWorkspace ws;
+        std::ostringstream os;
+    };
+
+    Workspace &workspace() {
+        static thread_local Workspace w;
+        return w;
+    }
+
+    // リクエストを解いてレスポンスを作る
+    std::string solve_request(const LayoutRequest &req, Workspace &w = workspace()) {
+        auto &E = w.E;
+        auto &mp = w.mp;
+        E.clear();
+        mp.clear();
+        for (auto [s, t] : req.E) {
+            int sid = mp.register_process(s);
+            int tid = mp.register_process(t);
+            E.push_back({sid, tid});
+        }
+        E = remove_multiple_edge(std::move(E));
+        renumber(mp, E);
+        int N = mp.size();
+        ProblemContext ctx(N, E);
+        if (!ctx.is_DAG()) return error_frame(req.id, "not a DAG");
+        auto pos = solve(req.engine, ctx, req.time_end, req.sample, req.resync);
+        auto &os = w.os;
+        os.str("");
+        os.clear();
+        auto metrics = evaluate_layout<LayoutMetrics::required<ScorePolicyDefault>() | LayoutMetrics::Cross | LayoutMetrics::BadPenetration>(pos, E, w.ws);
+        os << "RESULT " << req.id << ' ' << N << ' ' << metrics.score<ScorePolicyDefault>() << ' ' << metrics.length << ' ' << metrics.cross << ' ' << metrics.bad_penetration << '\n';
+        for (int i = 0; i < N; i++) {
+            os << mp.get_process(i) << ',' << pos[i].first << ',' << pos[i].second << '\n';
+        }
+        os << "END " << req.id << '\n';
+        return os.str();
+    }
+};
+
+// リクエストをTaskPoolのタスクとして処理する
+// 手法の中の並列化も同じプールを使うので, 同時に動くスレッドはワーカー数を超えない
+// ワーカー数より多いリクエストはプールのキューで順に待つ
+struct LayoutService {
+  private:
+    TaskPool::TaskGroup group;
+
+  public:
+    // threads := プールのワーカー数, 0ならTaskPoolの既定 (プールを使い始める前に作った場合だけ効く)
+    LayoutService(int threads = 0) {
+        if (threads > 0) TaskPool::init(threads);
+    }
+
+    // 処理中のリクエストが全て終わるまで待つ
+    ~LayoutService() {
+        group.wait();
+    }
+
+    void push(LayoutRequest req, FrameWriter write) {
+        auto job = std::make_shared<std::pair<LayoutRequest, FrameWriter>>(std::move(req), std::move(write));
+        group.run([job]() {
+            job->second(Service::solve_request(job->first));
+        });
+    }
+
+    // 入力が終わるまでリクエストを読んで処理を依頼する
+    // 読み終わった時点で処理中のリクエストがあっても待たずに返る
+    void serve(LineReader read_line, FrameWriter write) {
+        LayoutRequest req;
+        std::string err, next;
+        while (true) {
+            bool ok = Service::read_request(read_line, req, err, next);
+            if (!err.empty()) write(Service::error_frame(req.id, err));
+            else if (ok) push(req, write);
+            if (!ok) break;
+        }
+    }
+};
+#endif
@@ -1,6 +1,8 @@
 #ifndef _SIMULATED_ANNEALING_H_
 #define _SIMULATED_ANNEALING_H_
 #include "Random.hpp"
+#include "SearchControl.hpp"
+#include "TaskPool.hpp"
 #include <chrono>
 #include <cassert>
 
@@ -10,10 +12,11 @@ long long timems() {
     return std::chrono::duration_cast<std::chrono::milliseconds>(p).count();
 }
 
+// 状態はスレッドごとに持つので, 別スレッドで同じidのtimerを使っても干渉しない
 template<int id>
 struct timer {
-    static bool ok; // set済みか
-    static long long T0;
+    static thread_local bool ok; // set済みか
+    static thread_local long long T0;
     // 基準点をセット
     static void set() {
         ok = true;
@@ -26,14 +29,14 @@ struct timer {
     };
 };
 template<int id>
-bool timer<id>::ok(false);
+thread_local bool timer<id>::ok(false);
 template<int id>
-long long timer<id>::T0(0);
+thread_local long long timer<id>::T0(0);
 
 template<int id>
 struct temperature_scheduler_exp {
-    static bool ok;
-    static double T0, T1, Tend;
+    static thread_local bool ok;
+    static thread_local double T0, T1, Tend;
     // 指数スケジューリング
     // t := 時刻を[0, 1]に正規化したもの
     // Tcur = T0 ^ (1 - t) * T1 ^ t
@@ -59,34 +62,135 @@ struct temperature_scheduler_exp {
         T diff_score = score_after - score_before;
         return diff_score <= 0 ? 1 : std::exp((double)-diff_score / Tcur);
     }
+    // 遷移を受理したかどうかの通知 (何もしない)
+    static void notify(bool accepted) {}
 };
 template<int id>
-bool temperature_scheduler_exp<id>::ok(false);
+thread_local bool temperature_scheduler_exp<id>::ok(false);
 template<int id>
-double temperature_scheduler_exp<id>::T0(0);
+thread_local double temperature_scheduler_exp<id>::T0(0);
 template<int id>
-double temperature_scheduler_exp<id>::T1(0);
+thread_local double temperature_scheduler_exp<id>::T1(0);
 template<int id>
-double temperature_scheduler_exp<id>::Tend(0);
+thread_local double temperature_scheduler_exp<id>::Tend(0);
+
+// 再加熱つきの指数スケジューリング
+// Window回の遷移ごとに受理率を見て, MinAccept未満なら温度をFactor倍する(ただしT0を超えない)
+// 受理率が戻ったら倍率を1回ごとに半分にして元のスケジュールに戻す
+template<int id>
+struct temperature_scheduler_reheat : temperature_scheduler_exp<id> {
+    using base = temperature_scheduler_exp<id>;
+    // 設定は全スレッドで共有し, 受理数などの途中経過だけスレッドごとに持つ
+    static int Window;
+    static double MinAccept, Factor;
+    static thread_local int cnt, acc;
+    static thread_local double boost;
+    static void set(double T0_, double T1_, double Tend_) {
+        base::set(T0_, T1_, Tend_);
+        cnt = acc = 0;
+        boost = 1;
+    }
+    // 再加熱の設定, 焼きなましを始める前に(どのスレッドからでも)1回呼ぶ
+    static void set_reheat(int Window_, double MinAccept_, double Factor_) {
+        Window = Window_;
+        MinAccept = MinAccept_;
+        Factor = Factor_;
+    }
+    static double get(double elapse_ms) {
+        double T = base::get(elapse_ms);
+        boost = std::min(boost, base::T0 / T);
+        return T * boost;
+    }
+    static void notify(bool accepted) {
+        cnt++;
+        acc += accepted;
+        if (cnt < Window) return;
+        if (acc < MinAccept * cnt) boost *= Factor;
+        else boost = std::max(1.0, boost * 0.5);
+        cnt = acc = 0;
+    }
+};
+template<int id>
+int temperature_scheduler_reheat<id>::Window(1000);
+template<int id>
+thread_local int temperature_scheduler_reheat<id>::cnt(0);
+template<int id>
+thread_local int temperature_scheduler_reheat<id>::acc(0);
+template<int id>
+double temperature_scheduler_reheat<id>::MinAccept(0.01);
+template<int id>
+double temperature_scheduler_reheat<id>::Factor(10);
+template<int id>
+thread_local double temperature_scheduler_reheat<id>::boost(1);
+
+/*
+温度の自動調整
+samples回ランダムに遷移してすぐ戻し, 悪化する遷移の悪化量の平均dを求める
+悪化量dの遷移の受理確率が開始時にp0, 終了時にp1になるように T = -d / log(p) とする
+状態は変化しない (Stateにはrandom_update, rollback, get_scoreが必要)
+time_limit >= 0 なら, time_limit(ms)を過ぎた時点で遷移を試すのをやめる (評価が重い大きな入力で焼きなましの時間を食わないように)
+返り値 : (T0, T1)
+*/
+template<typename State>
+std::pair<double, double> calibrate_temperature(State &v, int samples = 1000, double p0 = 0.5, double p1 = 0.001, int time_limit = -1) {
+    double sum = 0;
+    int cnt = 0;
+    auto score = v.get_score();
+    long long start = timems();
+    for (int i = 0; i < samples; i++) {
+        if (time_limit >= 0 && i > 0 && timems() - start >= time_limit) break;
+        v.random_update();
+        double d = v.get_score() - score;
+        v.rollback();
+        if (d > 0) {
+            sum += d;
+            cnt++;
+        }
+    }
+    double d = (cnt == 0 ? 1.0 : sum / cnt);
+    return {-d / std::log(p0), -d / std::log(p1)};
+}
 
 // FreqTempUpdate := この回数ごとに1回時刻と温度を更新
+// Stateには get_score, random_update, rollback の他に
+// これまでの最良スコアを返す get_best_score と最良解を更新したときに呼ばれる save_best が必要
 template<typename Timer, typename Temp, typename State>
 struct simulated_annealing {
     using UpdateType = typename State::UpdateType;
     using ScoreType = typename State::ScoreType;
+
+    // 途中経過を受け取らない場合のコールバック
+    struct no_report {
+        void operator ()(State &, long long) {}
+    };
+
     void operator ()(State &v, double _Temp0, double _Temp1, int _TimeEnd, int _FreqTempUpdate) {
+        (*this)(v, _Temp0, _Temp1, _TimeEnd, _FreqTempUpdate, 0, 0, no_report());
+    }
+
+    // TimeStart := 開始時点で既に経過しているとみなす時間(ms)
+    //              チェックポイントから再開する場合に温度の位置を引き継ぐために使う
+    // ReportInterval := この間隔(ms)ごとに report(v, 現在時刻) を呼ぶ, 0以下なら呼ばない
+    template<typename Report>
+    void operator ()(State &v, double _Temp0, double _Temp1, int _TimeEnd, int _FreqTempUpdate, int _TimeStart, int _ReportInterval, Report report) {
         int TimeEnd = _TimeEnd; // 終了時刻
         int TimeCur; // 現在時刻
         double TempCur; // 現在の温度
-        Timer::set();
         Temp::set(_Temp0, _Temp1, _TimeEnd);
         ScoreType score_cur = v.get_score();
+        ScoreType score_best = v.get_best_score();
+        search_report(score_best);
+        long long TimeReport = _TimeStart + _ReportInterval; // 次に途中経過を出す時刻
         Timer::set();
         int i = _FreqTempUpdate;
         while (true) {
             if (i == _FreqTempUpdate) {
-                TimeCur = Timer::elapse();
-                if (TimeCur >= TimeEnd) return;
+                TimeCur = _TimeStart + Timer::elapse();
+                if (_ReportInterval > 0 && TimeCur >= TimeReport) {
+                    report(v, TimeCur);
+                    TimeReport = TimeCur + _ReportInterval;
+                }
+                if (TimeCur >= TimeEnd || search_stop_requested()) return;
                 TempCur = Temp::get(TimeCur);
                 i = 0;
             }
@@ -94,9 +198,57 @@ struct simulated_annealing {
             v.random_update();
             ScoreType score_next = v.get_score();
             double prob = Temp::p_move(score_cur, score_next, TempCur);
-            if (!rng.judge(prob)) v.rollback();
-            else score_cur = score_next;
+            bool accepted = rng.judge(prob);
+            Temp::notify(accepted);
+            if (!accepted) v.rollback();
+            else {
+                score_cur = score_next;
+                if (score_cur < score_best) {
+                    score_best = score_cur;
+                    v.save_best();
+                    search_report(score_best);
+                }
+            }
         }
     }
 };
-#endif
\ No newline at end of file
+
+/*
+複数の状態(レプリカ)を, それぞれ別のタスクとして独立に焼きなます
+i番目のレプリカの乱数の種は seed + i (どのスレッドで実行されても同じ列になる)
+seedが負なら, 呼んだスレッドのrngからレプリカごとに種を引く (呼ぶ側のrngの種が違えば別の列になる)
+timer, 温度, 乱数はスレッドごとに持つので, 同じidを使っても干渉しない
+レプリカを実行したスレッドのrngは, レプリカが終わると実行前の状態に戻る
+ワーカーが空くのを待っていたレプリカは, 待った時間だけ進んだ温度から始めて TimeEnd に終える
+返り値 : get_best_score が最小のレプリカの添字
+*/
+template<typename Timer, typename Temp, typename State>
+int simulated_annealing_replicas(std::vector<State> &vs, double _Temp0, double _Temp1, int _TimeEnd, int _FreqTempUpdate, int seed = -1) {
+    int R = vs.size();
+    assert(R > 0);
+    std::vector<int> seeds(R);
+    for (int i = 0; i < R; i++) seeds[i] = (seed >= 0 ? seed + i : (int)rng.random_number());
+    auto start = std::chrono::steady_clock::now();
+    {
+        TaskPool::TaskGroup g;
+        for (int i = 0; i < R; i++) {
+            g.run([&, i]() {
+                // 実行するスレッドのrngを借りるので, 終わったら元の状態に戻す
+                // (呼んだスレッドやワーカーが後で使う乱数列はレプリカの種に影響されない)
+                auto saved = rng;
+                rng.set_seed(seeds[i]);
+                int waited = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+                if (waited < _TimeEnd) {
+                    simulated_annealing<Timer, Temp, State>()(vs[i], _Temp0, _Temp1, _TimeEnd, _FreqTempUpdate, waited, 0, typename simulated_annealing<Timer, Temp, State>::no_report());
+                }
+                rng = saved;
+            });
+        }
+    }
+    int best = 0;
+    for (int i = 1; i < R; i++) {
+        if (vs[i].get_best_score() < vs[best].get_best_score()) best = i;
+    }
+    return best;
+}
+#endif
@@ -0,0 +1,201 @@
+#ifndef _STATE_SA_H_
+#define _STATE_SA_H_
+#include "Lib.hpp"
+#include "Random.hpp"
+#include "ScoreCache.hpp"
+#include "ProblemContext.hpp"
+#include <numeric>
+#include <limits>
+
+// パスの並び順とx座標を焼きなます状態
+// Policy := calc_scoreの重み (ScorePolicyDefault を参照)
+template<typename Policy = ScorePolicyDefault>
+struct StateSA {
+    using UpdateType = std::tuple<int, int, int>;
+    using ScoreType = double;
+    ScoreType score;
+    std::vector<int> perm;
+    int N;
+    std::tuple<int, int, int> last_query;
+    double last_score;
+    // 入力から決まる変わらない部分は文脈のものを参照する (レプリカを増やしてもコピーしない)
+    const std::vector<std::vector<int>> &P;
+    const std::vector<int> &minX, &ord;
+    const std::vector<std::pair<int, int>> &E;
+    const CSRGraph &G;
+    std::vector<int> curX;
+    ScoreType best_score;
+    std::vector<int> best_perm, best_curX; // これまでの最良解
+    uint64_t key, last_key; // (perm, curX)のZobristハッシュ
+    ScoreCache<ScoreType> cache; // 評価済みの(perm, curX)のスコア
+    std::vector<int> tmpX; // random_update で使う作業用の配列
+    ScoreWorkspace ws;
+
+    // パスは文脈のパスへの分解, 横軸の初期値は文脈の列 (隣接リストとトポロジカル順も文脈のものを使う)
+    // ctxは状態(とそのコピー)より長く生きている必要がある
+    StateSA(const ProblemContext &ctx) : score(std::numeric_limits<double>::max()), perm(ctx.long_paths().size()), N(ctx.size()), P(ctx.long_paths()), minX(ctx.min_x()), ord(ctx.topological_order()), E(ctx.edges()), G(ctx.graph()), curX(ctx.min_x()) {
+        init();
+    }
+
+    void init() {
+        std::iota(perm.begin(), perm.end(), 0);
+        auto tmpX = curX;
+        auto pos = compress_y(P, perm, tmpX);
+        score = calc_score<Policy>(pos, E);
+        key = Zobrist::perm_key(perm) ^ Zobrist::x_key(curX);
+        save_best();
+    }
+
+    std::vector<int> make_tmpX() {
+        return make_tmpX(curX);
+    }
+
+    // Xを始点に前後関係を満たすように右にずらしたものをresに入れる
+    void make_tmpX(const std::vector<int> &X, std::vector<int> &res) const {
+        res.assign(X.begin(), X.end());
+        for (int s : ord) {
+            for (int t : G[s]) {
+                res[t] = std::max(res[t], res[s] + 1);
+            }
+        }
+    }
+
+    // Xを始点に前後関係を満たすように右にずらしたもの
+    std::vector<int> make_tmpX(const std::vector<int> &X) const {
+        std::vector<int> res;
+        make_tmpX(X, res);
+        return res;
+    }
+
+    void random_update() {
+        int M = P.size();
+        int type = rng.random_number() % 3;
+        //type = 0;
+        last_key = key;
+        if (type == 0) {
+            int a = rng.random_number() % M;
+            int b = rng.random_number() % M;
+            key ^= Zobrist::perm_term(a, perm[a]) ^ Zobrist::perm_term(b, perm[b]);
+            std::swap(perm[a], perm[b]);
+            key ^= Zobrist::perm_term(a, perm[a]) ^ Zobrist::perm_term(b, perm[b]);
+            last_query = {0, a, b};
+        } else if (type == 1) {
+            int a = rng.random_number() % N;
+            last_query = {1, a, 1};
+            key ^= Zobrist::x_term(a, curX[a]) ^ Zobrist::x_term(a, curX[a] + 1);
+            curX[a]++;
+        } else {
+            int a = rng.random_number() % N;
+            if (curX[a] == minX[a]) {
+                last_query = {2, a, 0};
+            } else {
+                last_query = {2, a, 1};
+                key ^= Zobrist::x_term(a, curX[a]) ^ Zobrist::x_term(a, curX[a] - 1);
+                curX[a]--;
+            }
+        }
+        last_score = score;
+        score = cache.get(key, [&]() {
+            make_tmpX(curX, tmpX);
+            return calc_score<Policy>(compress_y(P, perm, tmpX, ws), E, ws);
+        });
+    }
+
+    void rollback() {
+        auto [type, a, b] = last_query;
+        key = last_key;
+        if (type == 0) {
+            std::swap(perm[a], perm[b]);
+            score = last_score;
+        } else if (type == 1) {
+            curX[a]--;
+            score = last_score;
+        } else {
+            curX[a] += b;
+            score = last_score;
+        }
+    }
+
+    ScoreType get_score() {
+        return score;
+    }
+
+    ScoreType get_best_score() {
+        return best_score;
+    }
+
+    void save_best() {
+        best_score = score;
+        best_perm = perm;
+        best_curX = curX;
+    }
+
+    // 最良解の配置
+    std::vector<std::pair<int, int>> best_pos() {
+        return compress_y(P, best_perm, make_tmpX(best_curX));
+    }
+
+    // チェックポイントを書き出す
+    // elapse := 焼きなましの経過時間(ms), 再開時に温度の位置を引き継ぐ
+    // 別の入力のチェックポイントを読まないように辺集合のハッシュも書く
+    void save(std::ostream &os, long long elapse) const {
+        auto write = [&](const std::vector<int> &A) {
+            for (int a : A) os << a << ' ';
+            os << '\n';
+        };
+        os << N << ' ' << P.size() << ' ' << Zobrist::edges_key(E) << ' ' << elapse << '\n';
+        write(perm);
+        write(curX);
+        write(best_perm);
+        write(best_curX);
+        rng.save(os);
+        os << '\n';
+    }
+
+    // チェックポイントを読み込んで経過時間(ms)を返す
+    // 別の入力のものや壊れたもの(permが順列でない, curXがminXより左にあるなど)の場合は何もせず-1を返す
+    // 全て読んで確かめてから状態を書き換える
+    long long load(std::istream &is) {
+        int n, k;
+        uint64_t hash;
+        long long elapse;
+        if (!(is >> n >> k >> hash >> elapse) || n != N || k != P.size() || hash != Zobrist::edges_key(E) || elapse < 0) return -1;
+        auto read = [&](std::vector<int> &A, int sz) {
+            A.resize(sz);
+            for (int &a : A) is >> a;
+        };
+        std::vector<int> _perm, _curX, _best_perm, _best_curX;
+        read(_perm, k);
+        read(_curX, n);
+        read(_best_perm, k);
+        read(_best_curX, n);
+        auto _rng = rng;
+        _rng.load(is);
+        if (!is) return -1;
+        auto is_perm = [&](const std::vector<int> &A) {
+            std::vector<char> seen(k, 0);
+            for (int a : A) {
+                if (a < 0 || a >= k || seen[a]) return false;
+                seen[a] = 1;
+            }
+            return true;
+        };
+        auto is_feasible = [&](const std::vector<int> &X) {
+            for (int v = 0; v < N; v++) {
+                if (X[v] < minX[v]) return false;
+            }
+            return true;
+        };
+        if (!is_perm(_perm) || !is_perm(_best_perm) || !is_feasible(_curX) || !is_feasible(_best_curX)) return -1;
+        perm = std::move(_perm);
+        curX = std::move(_curX);
+        best_perm = std::move(_best_perm);
+        best_curX = std::move(_best_curX);
+        rng = _rng;
+        score = calc_score<Policy>(compress_y(P, perm, make_tmpX()), E);
+        key = Zobrist::perm_key(perm) ^ Zobrist::x_key(curX);
+        best_score = calc_score<Policy>(best_pos(), E);
+        return elapse;
+    }
+};
+#endif
\ No newline at end of file
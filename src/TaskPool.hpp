@@ -0,0 +1,266 @@
+#ifndef _TASK_POOL_H_
+#define _TASK_POOL_H_
+#include "SearchControl.hpp"
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <algorithm>
+#include <cstddef>
+#include <chrono>
+
+/*
+プロセス全体で共有するワークスティーリングのスレッドプール
+ワーカーはそれぞれ両端キューを持ち, 自分が積んだタスクは後ろから, 他のワーカーのタスクは前から盗んで実行する
+ワーカー以外のスレッドが積んだタスクは共有のキューに入れる
+TaskGroup::run でタスクを積み, TaskGroup::wait で全て終わるまで待つ (タスクの中で入れ子にしてよい)
+ワーカーが待つ間は自分のキューに残っているタスクを実行する (他のワーカーから盗まないので, 長いタスクに捕まらない)
+ワーカー数は最初に使う前に TaskPool::init で1回だけ決める. 呼ばなければハードウェアのスレッド数
+タスクには積んだスレッドの search_control を引き継ぐ
+*/
+namespace TaskPool {
+    // ワーカーごとの作業用メモリ (確保した順に解放する一時領域)
+    // ArenaScopeを抜けると, その間に確保した領域は再利用される
+    struct Arena {
+      private:
+        static constexpr size_t block_size = 1 << 20;
+        std::vector<std::unique_ptr<std::max_align_t[]>> blocks;
+        std::vector<size_t> cap; // ブロックの大きさ(max_align_t単位)
+        size_t cur = 0, used = 0; // 使用中のブロックと, その中の使用量
+
+      public:
+        // n個のTの領域 (初期化しない, Tはtrivialな型)
+        template<typename T>
+        T *alloc(size_t n) {
+            size_t m = (n * sizeof(T) + sizeof(std::max_align_t) - 1) / sizeof(std::max_align_t);
+            while (cur < blocks.size() && used + m > cap[cur]) {
+                cur++;
+                used = 0;
+            }
+            if (cur == blocks.size()) {
+                size_t c = std::max(m, block_size / sizeof(std::max_align_t));
+                blocks.emplace_back(new std::max_align_t[c]);
+                cap.push_back(c);
+                used = 0;
+            }
+            T *p = reinterpret_cast<T *>(blocks[cur].get() + used);
+            used += m;
+            return p;
+        }
+
+        std::pair<size_t, size_t> mark() const {
+            return {cur, used};
+        }
+
+        void rewind(std::pair<size_t, size_t> m) {
+            cur = m.first;
+            used = m.second;
+        }
+    };
+
+    struct ArenaScope {
+        Arena &arena;
+        std::pair<size_t, size_t> m;
+        ArenaScope(Arena &_arena) : arena(_arena), m(_arena.mark()) {}
+        ~ArenaScope() { arena.rewind(m); }
+    };
+
+    using Task = std::function<void()>;
+
+    struct Worker {
+        std::mutex mtx;
+        std::deque<Task> dq;
+    };
+
+    thread_local int worker_id = -1; // ワーカーでないスレッドは-1
+
+    class Pool {
+        std::vector<std::unique_ptr<Worker>> workers;
+        std::vector<std::thread> th;
+        std::mutex mtx;
+        std::condition_variable cv;
+        std::deque<Task> inject; // ワーカー以外が積んだタスク
+        std::atomic<int> queued{0}; // キューにあるタスクの数
+        bool closed = false;
+
+        bool pop_own(int id, Task &t) {
+            auto &w = *workers[id];
+            std::lock_guard<std::mutex> lock(w.mtx);
+            if (w.dq.empty()) return false;
+            t = std::move(w.dq.back());
+            w.dq.pop_back();
+            queued--;
+            return true;
+        }
+
+        bool pop_any(int id, Task &t) {
+            if (pop_own(id, t)) return true;
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                if (!inject.empty()) {
+                    t = std::move(inject.front());
+                    inject.pop_front();
+                    queued--;
+                    return true;
+                }
+            }
+            int W = workers.size();
+            for (int k = 1; k < W; k++) {
+                auto &w = *workers[(id + k) % W];
+                std::lock_guard<std::mutex> lock(w.mtx);
+                if (w.dq.empty()) continue;
+                t = std::move(w.dq.front());
+                w.dq.pop_front();
+                queued--;
+                return true;
+            }
+            return false;
+        }
+
+        void work(int id) {
+            worker_id = id;
+            Task t;
+            while (true) {
+                if (pop_any(id, t)) {
+                    t();
+                    continue;
+                }
+                std::unique_lock<std::mutex> lock(mtx);
+                cv.wait(lock, [&]() { return closed || queued.load() > 0; });
+                if (closed && queued.load() == 0) return;
+            }
+        }
+
+      public:
+        Pool(int threads) {
+            for (int i = 0; i < threads; i++) workers.emplace_back(new Worker());
+            for (int i = 0; i < threads; i++) th.emplace_back([this, i]() { work(i); });
+        }
+
+        ~Pool() {
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                closed = true;
+            }
+            cv.notify_all();
+            for (auto &t : th) t.join();
+        }
+
+        int size() const {
+            return workers.size();
+        }
+
+        void push(Task t) {
+            if (worker_id != -1) {
+                auto &w = *workers[worker_id];
+                std::lock_guard<std::mutex> lock(w.mtx);
+                w.dq.push_back(std::move(t));
+                queued++;
+            } else {
+                std::lock_guard<std::mutex> lock(mtx);
+                inject.push_back(std::move(t));
+                queued++;
+            }
+            // 寝ているワーカーとの競合を避けるためロックを取ってから起こす
+            { std::lock_guard<std::mutex> lock(mtx); }
+            cv.notify_one();
+        }
+
+        // ワーカーなら自分のキューのタスクを実行しながら, done()がtrueになるまで待つ
+        // ワーカー以外のスレッドは, しばらく待っても終わらなければ少しずつ寝て待つ (コアを使わない)
+        template<typename F>
+        void help_until(F done) {
+            Task t;
+            for (int spin = 0; !done(); spin++) {
+                if (worker_id != -1 && pop_own(worker_id, t)) {
+                    t();
+                    spin = 0;
+                } else if (worker_id != -1 || spin < 1000) {
+                    std::this_thread::yield();
+                } else {
+                    std::this_thread::sleep_for(std::chrono::microseconds(50));
+                }
+            }
+        }
+    };
+
+    int &configured_threads() {
+        static int threads = 0;
+        return threads;
+    }
+
+    // ワーカー数を決める. 最初にプールを使うより前に呼ぶこと (0ならハードウェアのスレッド数)
+    void init(int threads) {
+        configured_threads() = threads;
+    }
+
+    Pool &pool() {
+        static Pool p([]() {
+            int threads = configured_threads();
+            if (threads <= 0) threads = std::max(1u, std::thread::hardware_concurrency());
+            return threads;
+        }());
+        return p;
+    }
+
+    // ワーカー数
+    int size() {
+        return pool().size();
+    }
+
+    // 今のスレッドの作業用メモリ
+    Arena &arena() {
+        static thread_local Arena a;
+        return a;
+    }
+
+    // fork/join のまとまり
+    struct TaskGroup {
+        std::atomic<int> pending{0};
+
+        TaskGroup() = default;
+        TaskGroup(const TaskGroup &) = delete;
+        ~TaskGroup() { wait(); }
+
+        template<typename F>
+        void run(F f) {
+            pending++;
+            SearchControl *c = search_control;
+            pool().push([this, f, c]() mutable {
+                SearchControl *prev = search_control;
+                search_control = c;
+                f();
+                search_control = prev;
+                pending--;
+            });
+        }
+
+        void wait() {
+            pool().help_until([&]() { return pending.load() == 0; });
+        }
+    };
+
+    // [0, n)の各iについてf(i)を呼ぶ. grain個ずつに分けてタスクにする
+    // ワーカーが1つしかない場合やnがgrain以下の場合はこのスレッドで順に呼ぶ
+    template<typename F>
+    void parallel_for(int n, F f, int grain = 64) {
+        if (n <= grain || size() <= 1) {
+            for (int i = 0; i < n; i++) f(i);
+            return;
+        }
+        TaskGroup g;
+        for (int l = grain; l < n; l += grain) {
+            int r = std::min(n, l + grain);
+            g.run([&f, l, r]() {
+                for (int i = l; i < r; i++) f(i);
+            });
+        }
+        for (int i = 0; i < std::min(n, grain); i++) f(i);
+        g.wait();
+    }
+};
+#endif
@@ -0,0 +1,59 @@
+#include "CheckLib.hpp"
+#include "Lib.hpp"
+#include "WarmStart.hpp"
+#include "ParallelScore.hpp"
+
+// 前回の配置から始めて変更された部分だけ配置し直す
+int main() {
+    std::string path_in = "../testcase/case1.csv";
+    std::string path_prev = "../testcase/case1_ans.csv"; // 前回の配置
+    std::string path_prev_in = ""; // 前回の入力, 空でなければ追加された辺の端点も配置し直す
+    std::string path_out = "../testcase/case1_ws.csv";
+    int time_end = 200;
+
+    assert(CheckLib::is_valid_input(path_in));
+    std::vector<std::pair<int, int>> E;
+    ProcessMap mp;
+    for (auto [s, t] : CheckLib::read_csv(path_in)) {
+        int sid = mp.register_process(s);
+        int tid = mp.register_process(t);
+        E.push_back({sid, tid});
+    }
+    E = remove_multiple_edge(E);
+    renumber(mp, E);
+    int N = mp.size();
+
+    // 工程名で前回の配置と対応づける. 今回存在しない工程は無視する
+    std::vector<std::pair<int, int>> prev(N, {-1, -1});
+    for (auto [name, x, y] : CheckLib::read_layout(path_prev)) {
+        int id = mp.get_id(name);
+        if (id != -1) prev[id] = {x, y};
+    }
+    std::vector<std::pair<int, int>> prev_E;
+    if (!path_prev_in.empty()) {
+        for (auto [s, t] : CheckLib::read_csv(path_prev_in)) {
+            int sid = mp.get_id(s), tid = mp.get_id(t);
+            if (sid != -1 && tid != -1) prev_E.push_back({sid, tid});
+        }
+    }
+
+    ProblemContext ctx(N, E);
+    auto pos = solve_warm_start(ctx, prev, prev_E, time_end);
+    int moved = 0;
+    for (int i = 0; i < N; i++) moved += (pos[i] != prev[i]);
+    std::cout << "moved is " << moved << '\n';
+
+    // スコア計算
+    auto metrics = evaluate_layout_parallel(pos, E, LayoutMetrics::required<ScorePolicyDefault>() | LayoutMetrics::Cross | LayoutMetrics::BadPenetration);
+    double score = metrics.score<ScorePolicyDefault>();
+    std::cout << "score is " << score << '\n';
+    std::cout << "lensum is " << metrics.length << '\n';
+    std::cout << "cross is " << metrics.cross << '\n';
+    std::cout << "penetration is " << metrics.bad_penetration << '\n';
+
+    std::vector<std::tuple<std::string, int, int>> ans(N);
+    for (int i = 0; i < N; i++) {
+        ans[i] = {mp.get_process(i), pos[i].first, pos[i].second};
+    }
+    CheckLib::write_csv(path_out, ans);
+}
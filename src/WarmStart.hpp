@@ -0,0 +1,145 @@
+#ifndef _WARM_START_H_
+#define _WARM_START_H_
+#include "Lib.hpp"
+#include "Random.hpp"
+#include "SimulatedAnnealing.hpp"
+#include "SearchControl.hpp"
+#include "ProblemContext.hpp"
+#include <set>
+
+/*
+前回の配置から始めて, 変更のあった部分だけを配置し直す
+1. 前回の配置がある工程はその位置を使い, 前後関係を満たすようにx座標を右にずらす
+2. 新しい工程, x座標がずれた工程, 他の工程と位置が重なった工程, 新しい辺の端点を「変更された工程」とする
+3. 変更された工程を, その列で隣接する工程のy座標の中央値に近い空いている位置に置く
+4. 変更された工程とそれに隣接する工程だけを動かす山登りで修正する
+変更の無い部分の配置は前回と同じになる
+*/
+
+// prev[i] := 工程iの前回の位置, 前回存在しなかった工程は{-1, -1}
+// prev_E := 前回の辺集合 (空なら辺の追加は変更として扱わない)
+// 隣接リストと列(calc_min_x)は文脈のものを使う
+template<typename Policy = ScorePolicyDefault>
+std::vector<std::pair<int, int>> solve_warm_start(const ProblemContext &ctx, const std::vector<std::pair<int, int>> &prev, const std::vector<std::pair<int, int>> &prev_E, int time_end) {
+    int N = ctx.size();
+    const auto &E = ctx.edges();
+    const auto &G = ctx.graph();
+    const auto &minX = ctx.min_x();
+    std::vector<bool> changed(N, false);
+    std::vector<std::pair<int, int>> pos(N, {-1, -1});
+
+    // 前後関係を満たすようにx座標を決める (minXの昇順はトポロジカル順)
+    std::vector<int> ord(N);
+    std::iota(ord.begin(), ord.end(), 0);
+    std::sort(ord.begin(), ord.end(), [&](int a, int b) { return minX[a] < minX[b]; });
+    for (int v : ord) {
+        int x = 0;
+        for (int u : G.rev(v)) x = std::max(x, pos[u].first + 1);
+        if (prev[v].first == -1) {
+            changed[v] = true;
+        } else {
+            if (x > prev[v].first) changed[v] = true;
+            x = std::max(x, prev[v].first);
+        }
+        pos[v].first = x;
+    }
+
+    // 新しい辺の端点
+    if (!prev_E.empty()) {
+        std::set<std::pair<int, int>> old(prev_E.begin(), prev_E.end());
+        for (auto [s, t] : E) {
+            if (!old.count({s, t})) changed[s] = changed[t] = true;
+        }
+    }
+
+    // 変更の無い工程を置く. 位置が重なった場合は後から来た方を変更された工程にする
+    std::set<std::pair<int, int>> used;
+    for (int v = 0; v < N; v++) {
+        if (changed[v]) continue;
+        pos[v].second = prev[v].second;
+        if (used.count(pos[v])) changed[v] = true;
+        else used.insert(pos[v]);
+    }
+
+    // 変更された工程を, 置いてある隣接工程のy座標の中央値に一番近い空いている位置に置く
+    std::vector<bool> placed(N);
+    for (int v = 0; v < N; v++) placed[v] = !changed[v];
+    for (int v : ord) {
+        if (!changed[v]) continue;
+        std::vector<int> ys;
+        for (int u : G[v]) if (placed[u]) ys.push_back(pos[u].second);
+        for (int u : G.rev(v)) if (placed[u]) ys.push_back(pos[u].second);
+        int y0 = 0;
+        if (!ys.empty()) {
+            std::sort(ys.begin(), ys.end());
+            y0 = ys[ys.size() / 2];
+        }
+        int x = pos[v].first;
+        for (int d = 0;; d++) {
+            if (!used.count({x, y0 + d})) {
+                pos[v].second = y0 + d;
+                break;
+            }
+            if (y0 - d >= 0 && !used.count({x, y0 - d})) {
+                pos[v].second = y0 - d;
+                break;
+            }
+        }
+        used.insert(pos[v]);
+        placed[v] = true;
+    }
+
+    // 動かしてよい工程: 変更された工程とその隣接工程
+    std::vector<int> region;
+    std::vector<bool> in_region(N, false);
+    for (int v = 0; v < N; v++) {
+        if (!changed[v]) continue;
+        in_region[v] = true;
+        for (int u : G[v]) in_region[u] = true;
+        for (int u : G.rev(v)) in_region[u] = true;
+    }
+    for (int v = 0; v < N; v++) if (in_region[v]) region.push_back(v);
+    if (region.empty()) return pos;
+
+    // 山登り: 動かしてよい工程を同じ列の別の高さに動かす(そこに工程があれば, それも動かしてよい場合に限り入れ替える)
+    std::map<std::pair<int, int>, int> at;
+    int H = 0;
+    for (int v = 0; v < N; v++) {
+        at[pos[v]] = v;
+        H = std::max(H, pos[v].second + 1);
+    }
+    // 試すたびに作業領域を確保し直さないように使い回す
+    ScoreWorkspace ws;
+    double score = calc_score<Policy>(pos, E, ws);
+    timer<0>::set();
+    while (timer<0>::elapse() < time_end && !search_stop_requested()) {
+        int v = region[rng.random_number() % region.size()];
+        int y = rng.random_number() % (H + 1);
+        auto [x, vy] = pos[v];
+        if (y == vy) continue;
+        auto itr = at.find({x, y});
+        int u = (itr == at.end() ? -1 : itr->second);
+        if (u != -1 && !in_region[u]) continue;
+        pos[v].second = y;
+        if (u != -1) pos[u].second = vy;
+        double new_score = calc_score<Policy>(pos, E, ws);
+        if (new_score < score) {
+            score = new_score;
+            search_report(score);
+            at.erase({x, vy});
+            at[{x, y}] = v;
+            if (u != -1) at[{x, vy}] = u;
+            H = std::max(H, y + 1);
+        } else {
+            pos[v].second = vy;
+            if (u != -1) pos[u].second = y;
+        }
+    }
+    return pos;
+}
+
+template<typename Policy = ScorePolicyDefault>
+std::vector<std::pair<int, int>> solve_warm_start(int N, const std::vector<std::pair<int, int>> &E, const std::vector<std::pair<int, int>> &prev, const std::vector<std::pair<int, int>> &prev_E, int time_end) {
+    return solve_warm_start<Policy>(ProblemContext(N, E), prev, prev_E, time_end);
+}
+#endif
@@ -1,9 +1,7 @@
 #include "CheckLib.hpp"
 #include "Lib.hpp"
-#include "Random.hpp"
-#include "SimulatedAnnealing.hpp"
-#include <queue>
-#include <chrono>
+#include "Engine.hpp"
+#include "ParallelScore.hpp"
 #include <cassert>
 
 // 山登り法
@@ -11,6 +9,7 @@
 int main() {
     std::string path_in = "../testcase/case2.csv";
     std::string path_out = "../testcase/case2_cl.csv";
+    int time_end = 2000;
     assert(CheckLib::is_valid_input(path_in));
     std::vector<std::pair<int, int>> E;
     ProcessMap mp;
@@ -20,53 +19,21 @@ int main() {
         E.push_back({sid, tid});
     }
     E = remove_multiple_edge(E);
+    renumber(mp, E);
     int N = mp.size();
-    auto G = adjacency_list(N, E);
-    auto X = calc_min_x(G);
-
-    // 縦方向の座標を雑に決める
-    std::vector<int> Y(N), xcnt(N, 0);
-    std::vector<std::vector<int>> Col(N);
-    for (int i = 0; i < N; i++) {
-        int x = X[i];
-        Y[i] = xcnt[x];
-        xcnt[x]++;
-        Col[x].push_back(i);
-    }
-
-    auto _calc_score = [&]() -> double {
-        std::vector<std::pair<int, int>> tmp(N);
-        for (int i = 0; i < N; i++) {
-            tmp[i] = {X[i], Y[i]};
-        }
-        return calc_score(tmp, E);
-    };
-
-    double score = _calc_score();
-
-    const int Tend = 2000;
-    timer<0>::set();
-    while (true) {
-        if (timer<0>::elapse() >= Tend) break;
-        int x = rng.random_number() % N;
-        int sz = Col[x].size();
-        if (sz <= 1) continue;
-        int a = Col[x][rng.random_number() % sz];
-        int b = Col[x][rng.random_number() % sz];
-        std::swap(Y[a], Y[b]);
-        double new_score = _calc_score();
-        if (new_score < score) {
-            score = new_score;
-        } else {
-            std::swap(Y[a], Y[b]);
-        }
-    }
-
-    std::vector<std::pair<int, int>> pos(N);
-    for (int i = 0; i < N; i++) {
-        pos[i] = {X[i], Y[i]};
-    }
+    ProblemContext ctx(N, E);
+    // 下界に達するか, time_end / 2 の間改善しなければ打ち切る
+    SearchControl control;
+    control.lower_bound = calc_lower_bound(ctx);
+    control.gap = 0;
+    control.stagnation_ms = time_end / 2;
+    search_control = &control;
+    // 辺が多い場合は受理の判定を辺の標本から推定したスコアで行う
+    int sample = (E.size() > 2000 ? 512 : 0);
+    auto pos = solve_climbing(ctx, time_end, sample);
+    double score = calc_score_parallel(pos, E);
     std::cout << "score is " << score << '\n';
+    std::cout << "gap is " << calc_gap(score, control.lower_bound) << '\n';
     std::vector<std::tuple<std::string, int, int>> P(N);
     for (int i = 0; i < N; i++) {
         P[i] = {mp.get_process(i), pos[i].first, pos[i].second};
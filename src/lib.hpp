@@ -12,6 +12,7 @@
 #include <queue>
 #include <cassert>
 #include <numeric>
+#include <cstdint>
 
 // 工程名と番号を1対1対応させるmap
 struct ProcessMap {
@@ -56,6 +57,20 @@ struct ProcessMap {
             return "";
         }
     }
+
+    // 全ての工程を消す (確保した領域は使い回す)
+    void clear() {
+        _mp.clear();
+        _S.clear();
+    }
+
+    // 番号を付け替える. new_id[今の番号] := 新しい番号 (0, ..., size() - 1 の順列)
+    void renumber(const std::vector<int> &new_id) {
+        std::vector<std::string> S(_S.size());
+        for (int i = 0; i < _S.size(); i++) S[new_id[i]] = _S[i];
+        _S = S;
+        for (auto &[s, id] : _mp) id = new_id[id];
+    }
 };
 
 // 辺集合 -> 隣接リスト
@@ -69,6 +84,70 @@ std::vector<std::vector<int>> adjacency_list(int N, const std::vector<std::pair<
     return ans;
 }
 
+/*
+辺集合から作る不変のグラフ(CSR形式)
+順方向と逆方向の隣接リストをそれぞれ1本の配列に詰めて持つ
+G[v] で順方向, G.rev(v) で逆方向の隣接頂点を範囲for文で走査できる (隣接頂点は辺集合での順番に並ぶ)
+std::vector<std::vector<int>>の隣接リストと同じ書き方で使える
+O(N + M)
+*/
+struct CSRGraph {
+    // 隣接頂点の範囲
+    struct range {
+        const int *b, *e;
+        const int *begin() const { return b; }
+        const int *end() const { return e; }
+        int size() const { return e - b; }
+        bool empty() const { return b == e; }
+        int operator [](int i) const { return b[i]; }
+    };
+
+  private:
+    int N;
+    std::vector<int> _off, _to, _roff, _from;
+
+  public:
+    CSRGraph() : N(0), _off(1, 0), _roff(1, 0) {}
+
+    // 数え上げソートで1回で作る
+    CSRGraph(int _N, const std::vector<std::pair<int, int>> &E) : N(_N), _off(_N + 1, 0), _to(E.size()), _roff(_N + 1, 0), _from(E.size()) {
+        for (auto [s, t] : E) {
+            assert(0 <= s && s < N);
+            assert(0 <= t && t < N);
+            _off[s + 1]++;
+            _roff[t + 1]++;
+        }
+        for (int i = 0; i < N; i++) {
+            _off[i + 1] += _off[i];
+            _roff[i + 1] += _roff[i];
+        }
+        std::vector<int> p(_off.begin(), _off.end() - 1), q(_roff.begin(), _roff.end() - 1);
+        for (auto [s, t] : E) {
+            _to[p[s]++] = t;
+            _from[q[t]++] = s;
+        }
+    }
+
+    int size() const {
+        return N;
+    }
+
+    // 辺の本数
+    int edge_size() const {
+        return _to.size();
+    }
+
+    // vから出る辺の行き先
+    range operator [](int v) const {
+        return {_to.data() + _off[v], _to.data() + _off[v + 1]};
+    }
+
+    // vに入る辺の始点
+    range rev(int v) const {
+        return {_from.data() + _roff[v], _from.data() + _roff[v + 1]};
+    }
+};
+
 // 多重辺を省く
 std::vector<std::pair<int, int>> remove_multiple_edge(std::vector<std::pair<int, int>> E) {
     std::sort(E.begin(), E.end());
@@ -77,45 +156,118 @@ std::vector<std::pair<int, int>> remove_multiple_edge(std::vector<std::pair<int,
 }
 
 /*
-負のx座標を使わないことにすると、各工程が存在できる最小のx座標が決まる。
-この値を計算する
-O(N)
+トポロジカル順 (Kahnの方法, 入次数が0になった順)
+閉路がある場合は閉路に含まれる工程とその先の工程が現れないので, 大きさがNより小さくなる
+Graph := 隣接リスト(std::vector<std::vector<int>>) または CSRGraph
+O(N + M)
 */
-std::vector<int> calc_min_x(const std::vector<std::vector<int>> &G) {
+template<typename Graph>
+std::vector<int> topological_order(const Graph &G) {
     int N = G.size();
-    std::vector<int> in(N, 0), X(N);
+    std::vector<int> in(N, 0), ord;
+    ord.reserve(N);
     for (int i = 0; i < N; i++) {
         for (int t : G[i]) {
             in[t]++;
         }
     }
-    std::queue<int> que;
     for (int i = 0; i < N; i++) {
-        if (in[i] == 0) {
-            X[i] = 0;
-            que.push(i);
+        if (in[i] == 0) ord.push_back(i);
+    }
+    for (int h = 0; h < ord.size(); h++) {
+        for (int t : G[ord[h]]) {
+            in[t]--;
+            if (in[t] == 0) ord.push_back(t);
         }
     }
-    while (!que.empty()) {
-        int s = que.front();
-        que.pop();
+    return ord;
+}
+
+/*
+負のx座標を使わないことにすると、各工程が存在できる最小のx座標が決まる。
+この値をトポロジカル順ordから計算する
+O(N + M)
+*/
+template<typename Graph>
+std::vector<int> calc_min_x(const Graph &G, const std::vector<int> &ord) {
+    std::vector<int> X(G.size(), 0);
+    for (int s : ord) {
         for (int t : G[s]) {
-            in[t]--;
-            if (in[t] == 0) {
-                X[t] = X[s] + 1;
-                que.push(t);
-            }
+            X[t] = std::max(X[t], X[s] + 1);
         }
     }
     return X;
 }
 
+// Graph := 隣接リスト(std::vector<std::vector<int>>) または CSRGraph
+template<typename Graph>
+std::vector<int> calc_min_x(const Graph &G) {
+    return calc_min_x(G, topological_order(G));
+}
+
+/*
+推移簡約: 他の経路で到達できる辺(a->b->cがあるときのa->cなど)を取り除く
+calc_min_xの昇順(トポロジカル順)に番号を振り直し, 到達可能な頂点集合をbit列で持つ
+終点をchunk_bits個ずつに区切って処理するのでメモリは O(N * chunk_bits / 64) ワード
+多重辺は除いておくこと
+O(NM / 64)
+*/
+std::vector<std::pair<int, int>> transitive_reduction(int N, const std::vector<std::pair<int, int>> &E, int memory_words = 1 << 23) {
+    auto X = calc_min_x(CSRGraph(N, E));
+    // ord[i] := トポロジカル順でi番目の頂点, rnk[v] := 頂点vの順位
+    std::vector<int> ord(N), rnk(N);
+    std::iota(ord.begin(), ord.end(), 0);
+    std::stable_sort(ord.begin(), ord.end(), [&](int a, int b) { return X[a] < X[b]; });
+    for (int i = 0; i < N; i++) rnk[ord[i]] = i;
+    // 順位で表した隣接リスト (行き先の順位の昇順)
+    std::vector<std::vector<std::pair<int, int>>> G(N); // (行き先の順位, 辺番号)
+    for (int i = 0; i < E.size(); i++) {
+        G[rnk[E[i].first]].push_back({rnk[E[i].second], i});
+    }
+    for (auto &g : G) std::sort(g.begin(), g.end());
+
+    const int W = std::max(1, std::min((N + 63) / 64, memory_words / std::max(N, 1))); // 1回に扱うワード数
+    const int B = W * 64;
+    std::vector<bool> redundant(E.size(), false);
+    std::vector<uint64_t> reach((size_t)N * W), acc(W);
+    for (int c0 = 0; c0 < N; c0 += B) {
+        int c1 = std::min(N, c0 + B);
+        // 順位がc1以上の頂点からは[c0, c1)に到達できない
+        std::fill(reach.begin(), reach.begin() + (size_t)c1 * W, 0);
+        for (int v = c1 - 1; v >= 0; v--) {
+            std::fill(acc.begin(), acc.end(), 0);
+            // 行き先の順位の昇順に見る. tに到達できる他の行き先はtより前に現れる
+            for (auto [t, id] : G[v]) {
+                if (t >= c1) break;
+                if (t >= c0) {
+                    int b = t - c0;
+                    if (acc[b >> 6] >> (b & 63) & 1) redundant[id] = true;
+                }
+                const uint64_t *r = &reach[(size_t)t * W];
+                for (int j = 0; j < W; j++) acc[j] |= r[j];
+                if (t >= c0) {
+                    int b = t - c0;
+                    acc[b >> 6] |= uint64_t(1) << (b & 63);
+                }
+            }
+            std::copy(acc.begin(), acc.end(), reach.begin() + (size_t)v * W);
+        }
+    }
+    std::vector<std::pair<int, int>> ans;
+    for (int i = 0; i < E.size(); i++) {
+        if (!redundant[i]) ans.push_back(E[i]);
+    }
+    return ans;
+}
+
 /*
 DAGなので最長パスが計算できる
 最長パスを取り去ることを繰り返して(全頂点使うまで)いくつかのパスに分解
+Graph := 隣接リスト(std::vector<std::vector<int>>) または CSRGraph
 O(N^2)
 */
-std::vector<std::vector<int>> decompose_long_path(const std::vector<std::vector<int>> &G) {
+template<typename Graph>
+std::vector<std::vector<int>> decompose_long_path(const Graph &G) {
     int N = G.size();
     std::vector<int> dep(N, -1), next(N, -1), used(N, 0);
     std::vector<std::vector<int>> ans;
@@ -157,6 +309,39 @@ std::vector<std::vector<int>> decompose_long_path(const std::vector<std::vector<
     return ans;
 }
 
+/*
+メモリアクセスの局所性のための番号の付け直し
+calc_min_xの列の昇順に番号を振り, 同じ列の中では元の番号の順にする
+同じ列の工程が近い番号になるので, pos, 辺集合, 隣接リストを番号順に見るループのメモリアクセスが連続に近くなる
+列の中の順序を変えないので, 列の中を番号順に見る決定的な手法(Greedy1など)の配置は付け直す前と同じになる
+返り値 : new_id[元の番号] := 新しい番号
+O(N + M)
+*/
+template<typename Graph>
+std::vector<int> locality_order(const Graph &G) {
+    int N = G.size();
+    auto X = calc_min_x(G);
+    std::vector<int> cnt(N + 1, 0), new_id(N);
+    for (int i = 0; i < N; i++) cnt[X[i] + 1]++;
+    for (int x = 0; x < N; x++) cnt[x + 1] += cnt[x];
+    for (int i = 0; i < N; i++) new_id[i] = cnt[X[i]]++;
+    return new_id;
+}
+
+// 工程の番号をlocality_orderに付け直し, 辺集合の番号も付け直す
+// 辺の並び順は変えない (辺の順で同点を決める手法の配置が付け直す前と変わらないように)
+// 出力時はmp.get_processで工程名に戻すので, 呼び出し側は新しい番号をそのまま使えばよい
+// 返り値 : new_id[元の番号] := 新しい番号
+std::vector<int> renumber(ProcessMap &mp, std::vector<std::pair<int, int>> &E) {
+    auto new_id = locality_order(CSRGraph(mp.size(), E));
+    mp.renumber(new_id);
+    for (auto &[s, t] : E) {
+        s = new_id[s];
+        t = new_id[t];
+    }
+    return new_id;
+}
+
 // 辺の長さの総和を返す
 double sum_edge_length(const std::vector<std::pair<int, int>> &pos, const std::vector<std::pair<int, int>> &E) {
     double ans = 0;
@@ -183,16 +368,58 @@ double sum_edge_length_naname(const std::vector<std::pair<int, int>> &pos, const
     return ans;
 }
 
-// 無視できない貫通を数える
-int count_bad_penetration(const std::vector<std::pair<int, int>> &pos, const std::vector<std::pair<int, int>> &E) {
-    int N = pos.size();
-    std::vector<int> idx(N);
-    std::iota(idx.begin(), idx.end(), 0);
-    std::sort(idx.begin(), idx.end(), [&](int a, int b) { return pos[a].first < pos[b].first; });
-    std::vector<std::vector<bool>> mat(N, std::vector<bool>(N, false));
-    for (auto [s, t] : E) {
-        mat[s][t] = true;
+/*
+スコア計算の作業用の配列
+1度確保した領域を次の呼び出しで使い回すので, 同じ大きさの問題を何度も評価する場合(焼きなましなど)は
+2回目以降ヒープから確保しない
+スレッドごとに別のものを使うこと
+*/
+struct ScoreWorkspace {
+    std::vector<int> idx; // 工程を(x座標, y座標, 番号)の順に並べたもの
+    std::vector<int> off, adj, cur; // 工程ごとの行き先 (昇順)
+    std::vector<char> used; // compress_y で使っている列
+    std::vector<int> mark; // usedを立てた列
+    std::vector<std::pair<int, int>> pos; // compress_y の結果
+
+    // 貫通を調べる準備 (格子点にある工程と辺の有無を引けるようにする)
+    // O(N log N + M log M)
+    void build(const std::vector<std::pair<int, int>> &_pos, const std::vector<std::pair<int, int>> &E) {
+        int N = _pos.size(), M = E.size();
+        idx.resize(N);
+        std::iota(idx.begin(), idx.end(), 0);
+        std::sort(idx.begin(), idx.end(), [&](int a, int b) { return std::tie(_pos[a], a) < std::tie(_pos[b], b); });
+        off.assign(N + 1, 0);
+        for (auto [s, t] : E) off[s + 1]++;
+        for (int i = 0; i < N; i++) off[i + 1] += off[i];
+        adj.resize(M);
+        cur.assign(off.begin(), off.end() - 1);
+        for (auto [s, t] : E) adj[cur[s]++] = t;
+        for (int i = 0; i < N; i++) std::sort(adj.begin() + off[i], adj.begin() + off[i + 1]);
+    }
+
+    // 格子点(x, y)にある工程のうち番号が最小のもの, 無ければ-1 (buildしたときの配置)
+    int find(const std::vector<std::pair<int, int>> &_pos, int x, int y) const {
+        auto it = std::lower_bound(idx.begin(), idx.end(), std::make_pair(x, y), [&](int a, const std::pair<int, int> &p) { return _pos[a] < p; });
+        if (it == idx.end() || _pos[*it] != std::make_pair(x, y)) return -1;
+        return *it;
+    }
+
+    // 格子点(x, y)にある工程の数 (buildしたときの配置)
+    int count(const std::vector<std::pair<int, int>> &_pos, int x, int y) const {
+        auto it = std::lower_bound(idx.begin(), idx.end(), std::make_pair(x, y), [&](int a, const std::pair<int, int> &p) { return _pos[a] < p; });
+        int cnt = 0;
+        for (; it != idx.end() && _pos[*it] == std::make_pair(x, y); it++) cnt++;
+        return cnt;
+    }
+
+    bool has_edge(int s, int t) const {
+        return std::binary_search(adj.begin() + off[s], adj.begin() + off[s + 1], t);
     }
+};
+
+// 無視できない貫通を数える
+int count_bad_penetration(const std::vector<std::pair<int, int>> &pos, const std::vector<std::pair<int, int>> &E, ScoreWorkspace &ws) {
+    ws.build(pos, E);
     int ans = 0;
 
     for (auto [s, t] : E) {
@@ -204,15 +431,9 @@ int count_bad_penetration(const std::vector<std::pair<int, int>> &pos, const std
         int x = pos[s].first + dx, y = pos[s].second + dy;
         int v = s;
         while (x != pos[t].first) {
-            int next = -1;
-            for (int i = 0; i < N; i++) {
-                if (pos[i].first == x && pos[i].second == y) {
-                    next = i;
-                    break;
-                }
-            }
+            int next = ws.find(pos, x, y);
             if (next != -1) {
-                if (!mat[v][next]) ans++;
+                if (!ws.has_edge(v, next)) ans++;
                 v = next;
             }
             x += dx;
@@ -222,16 +443,14 @@ int count_bad_penetration(const std::vector<std::pair<int, int>> &pos, const std
     return ans;
 }
 
+int count_bad_penetration(const std::vector<std::pair<int, int>> &pos, const std::vector<std::pair<int, int>> &E) {
+    ScoreWorkspace ws;
+    return count_bad_penetration(pos, E, ws);
+}
+
 // 無視できない貫通に関与する辺の長さの和
-int sum_edge_length_bad_penetration(const std::vector<std::pair<int, int>> &pos, const std::vector<std::pair<int, int>> &E) {
-    int N = pos.size();
-    std::vector<int> idx(N);
-    std::iota(idx.begin(), idx.end(), 0);
-    std::sort(idx.begin(), idx.end(), [&](int a, int b) { return pos[a].first < pos[b].first; });
-    std::vector<std::vector<bool>> mat(N, std::vector<bool>(N, false));
-    for (auto [s, t] : E) {
-        mat[s][t] = true;
-    }
+int sum_edge_length_bad_penetration(const std::vector<std::pair<int, int>> &pos, const std::vector<std::pair<int, int>> &E, ScoreWorkspace &ws) {
+    ws.build(pos, E);
     int ans = 0;
 
     for (auto [s, t] : E) {
@@ -244,15 +463,9 @@ int sum_edge_length_bad_penetration(const std::vector<std::pair<int, int>> &pos,
         int v = s;
         int dxsum = dx, dysum = dy;
         while (x != pos[t].first) {
-            int next = -1;
-            for (int i = 0; i < N; i++) {
-                if (pos[i].first == x && pos[i].second == y) {
-                    next = i;
-                    break;
-                }
-            }
+            int next = ws.find(pos, x, y);
             if (next != -1) {
-                if (!mat[v][next]) {
+                if (!ws.has_edge(v, next)) {
                     ans += std::sqrt(dxsum * dxsum + dysum * dysum);
                 }
                 v = next;
@@ -266,6 +479,11 @@ int sum_edge_length_bad_penetration(const std::vector<std::pair<int, int>> &pos,
     return ans;
 }
 
+int sum_edge_length_bad_penetration(const std::vector<std::pair<int, int>> &pos, const std::vector<std::pair<int, int>> &E) {
+    ScoreWorkspace ws;
+    return sum_edge_length_bad_penetration(pos, E, ws);
+}
+
 // 全ての貫通を数える
 int count_all_penetration(const std::vector<std::pair<int, int>> &pos, const std::vector<std::pair<int, int>> &E) {
     int N = pos.size();
@@ -275,7 +493,7 @@ int count_all_penetration(const std::vector<std::pair<int, int>> &pos, const std
         auto [tx, ty] = pos[t];
         for (int i = 0; i < N; i++) {
             auto [ix, iy] = pos[i];
-            if (sx < ix && ix < tx && (iy - ty) * (tx - sx) == (ty - sy) * (ix - sx)) {
+            if (sx < ix && ix < tx && (iy - sy) * (tx - sx) == (ty - sy) * (ix - sx)) {
                 ans++;
             }
         }
@@ -315,13 +533,188 @@ int count_edge_cross(const std::vector<std::pair<int, int>> &pos, const std::vec
     return ans;
 }
 
-// (辺の長さの総和) + a(無視できない貫通に関与する辺の長さの和)
+/*
+配置の評価指標
+evaluate_layout で求める指標を選ぶ (ビットの組み合わせ). 選ばなかった指標は0のまま
+*/
+struct LayoutMetrics {
+    enum : unsigned {
+        Length = 1, // sum_edge_length
+        Naname = 2, // sum_edge_length_naname
+        BadPenetration = 4, // count_bad_penetration
+        BadPenetrationLength = 8, // sum_edge_length_bad_penetration
+        AllPenetration = 16, // count_all_penetration
+        Cross = 32, // count_edge_cross
+        All = 63
+    };
+    double length = 0;
+    double naname = 0;
+    int bad_penetration = 0;
+    int bad_penetration_length = 0;
+    int all_penetration = 0;
+    int cross = 0;
+
+    // calc_score<Policy> に必要な指標
+    template<typename Policy>
+    static constexpr unsigned required() {
+        return (Policy::length != 0 ? unsigned(Length) : 0u) | (Policy::naname != 0 ? unsigned(Naname) : 0u) | (Policy::penetration != 0 ? unsigned(BadPenetrationLength) : 0u) | (Policy::cross != 0 ? unsigned(Cross) : 0u);
+    }
+
+    // Policyの重み付き和 (calc_score<Policy>と同じ順番に足すので結果は一致する)
+    template<typename Policy>
+    double score() const {
+        double ans = 0;
+        if constexpr (Policy::length != 0) ans += Policy::length * length;
+        if constexpr (Policy::naname != 0) ans += Policy::naname * naname;
+        if constexpr (Policy::penetration != 0) ans += Policy::penetration * bad_penetration_length;
+        if constexpr (Policy::cross != 0) ans += Policy::cross * cross;
+        return ans;
+    }
+};
+
+/*
+配置の評価指標を辺を1回たどってまとめて求める
+辺の長さは1辺につき1回だけ計算して長さと斜めの長さの両方に使い,
+辺が通る格子点も1回だけたどって無視できない貫通と全ての貫通を同時に数える
+各指標の値は個別の関数と一致する (辺の順に足すので, 切り捨ての位置も同じ)
+Metrics := 求める指標 (LayoutMetrics::Length | LayoutMetrics::Cross など). テンプレート引数なので, 選ばなかった指標の計算はコンパイル時に取り除かれる
+O(M * (辺の長さ) * log N + [Crossを求める] * M^2)
+*/
+template<unsigned Metrics = LayoutMetrics::All>
+LayoutMetrics evaluate_layout(const std::vector<std::pair<int, int>> &pos, const std::vector<std::pair<int, int>> &E, ScoreWorkspace &ws) {
+    LayoutMetrics res;
+    int M = E.size();
+    constexpr bool walk = Metrics & (LayoutMetrics::BadPenetration | LayoutMetrics::BadPenetrationLength | LayoutMetrics::AllPenetration);
+    if constexpr (walk) ws.build(pos, E);
+    for (int i = 0; i < M; i++) {
+        auto [s, t] = E[i];
+        auto [sx, sy] = pos[s];
+        auto [tx, ty] = pos[t];
+        int dx = tx - sx;
+        int dy = ty - sy;
+        if constexpr ((Metrics & (LayoutMetrics::Length | LayoutMetrics::Naname)) != 0) {
+            double len = std::sqrt(dx * dx + dy * dy);
+            if constexpr ((Metrics & LayoutMetrics::Length) != 0) res.length += len;
+            if constexpr ((Metrics & LayoutMetrics::Naname) != 0) {
+                if (dy != 0) res.naname += len;
+            }
+        }
+        if constexpr (walk) {
+            int g = std::gcd(dx, dy);
+            int ux = dx / g, uy = dy / g;
+            int x = sx + ux, y = sy + uy;
+            int v = s;
+            int dxsum = ux, dysum = uy;
+            while (x != tx) {
+                if constexpr ((Metrics & LayoutMetrics::AllPenetration) != 0) res.all_penetration += ws.count(pos, x, y);
+                int next = ws.find(pos, x, y);
+                if (next != -1) {
+                    if (!ws.has_edge(v, next)) {
+                        res.bad_penetration++;
+                        res.bad_penetration_length += std::sqrt(dxsum * dxsum + dysum * dysum);
+                    }
+                    v = next;
+                }
+                x += ux;
+                y += uy;
+                dxsum += ux;
+                dysum += uy;
+            }
+        }
+        if constexpr ((Metrics & LayoutMetrics::Cross) != 0) {
+            for (int j = i + 1; j < M; j++) {
+                auto [c, d] = E[j];
+                auto [cx, cy] = pos[c];
+                auto [ex, ey] = pos[d];
+                assert(sx != tx);
+                assert(cx != ex);
+                double s1 = double(ty - sy) / (tx - sx);
+                double s2 = double(ey - cy) / (ex - cx);
+                if (s1 != s2) {
+                    double cross_x = (s1 * sx - sy - s2 * cx + cy) / (s1 - s2);
+                    if (sx < cross_x && cross_x < tx && cx < cross_x && cross_x < ex) res.cross++;
+                }
+            }
+        }
+    }
+    return res;
+}
+
+template<unsigned Metrics = LayoutMetrics::All>
+LayoutMetrics evaluate_layout(const std::vector<std::pair<int, int>> &pos, const std::vector<std::pair<int, int>> &E) {
+    ScoreWorkspace ws;
+    return evaluate_layout<Metrics>(pos, E, ws);
+}
+
+/*
+calc_scoreの各項の重み
+length      : 辺の長さの総和
+naname      : 斜めの辺の長さの総和
+penetration : 無視できない貫通に関与する辺の長さの和
+cross       : 辺が交差する回数
+重みが0の項はコンパイル時に取り除かれて計算されない
+*/
+struct ScorePolicyDefault {
+    static constexpr double length = 1.0;
+    static constexpr double naname = 0.0;
+    static constexpr double penetration = 1.0;
+    static constexpr double cross = 0.0;
+};
+
+// 重みを整数の比 (各項 / Den) で指定するポリシー
+// C++17では浮動小数点数をテンプレート引数にできないため
+template<int Length, int Naname, int Penetration, int Cross, int Den = 1>
+struct ScorePolicy {
+    static constexpr double length = double(Length) / Den;
+    static constexpr double naname = double(Naname) / Den;
+    static constexpr double penetration = double(Penetration) / Den;
+    static constexpr double cross = double(Cross) / Den;
+};
+
+// ポリシーで指定した重み付き和
+// 重みが0の項は求めず, 残りの項は evaluate_layout で辺を1回たどってまとめて求める
+template<typename Policy>
+double calc_score(const std::vector<std::pair<int, int>> &pos, const std::vector<std::pair<int, int>> &E, ScoreWorkspace &ws) {
+    LayoutMetrics m = evaluate_layout<LayoutMetrics::required<Policy>()>(pos, E, ws);
+    return m.score<Policy>();
+}
+
+template<typename Policy>
+double calc_score(const std::vector<std::pair<int, int>> &pos, const std::vector<std::pair<int, int>> &E) {
+    ScoreWorkspace ws;
+    return calc_score<Policy>(pos, E, ws);
+}
+
+// (辺の長さの総和) + (無視できない貫通に関与する辺の長さの和)
 double calc_score(const std::vector<std::pair<int, int>> &pos, const std::vector<std::pair<int, int>> &E) {
-    // 定数
-    static constexpr double a = 1.0;
-    double lensum = sum_edge_length(pos, E);
-    double p_lensum = sum_edge_length_bad_penetration(pos, E);
-    return lensum + a * p_lensum;
+    return calc_score<ScorePolicyDefault>(pos, E);
+}
+
+/*
+calc_scoreの下界
+辺の長さは両端の列の差以上で, 他の項は0以上なので, 横軸をcalc_min_xにする配置では
+(calc_min_xの列の差の辺についての和) * (lengthの重み) を下回らない
+横軸を動かす手法(LongPath, ネットワーク単体法など)の配置はこれを下回りうるので calc_lower_bound_free_x を使う
+X := 各工程の列 (calc_min_x)
+*/
+template<typename Policy = ScorePolicyDefault, typename Graph>
+double calc_lower_bound(const Graph &G, const std::vector<int> &X) {
+    long long sum = 0;
+    for (int s = 0; s < G.size(); s++) {
+        for (int t : G[s]) sum += X[t] - X[s];
+    }
+    return Policy::length * sum;
+}
+
+// 列をcalc_min_xで求める版
+template<typename Policy = ScorePolicyDefault, typename Graph>
+double calc_lower_bound(const Graph &G) {
+    return calc_lower_bound<Policy>(G, calc_min_x(G));
+}
+
+// 下界との差の割合 (score - lb) / lb
+double calc_gap(double score, double lb) {
+    return lb > 0 ? (score - lb) / lb : 0;
 }
 
 /*
@@ -332,19 +725,23 @@ oo
 oooooo
 oo  oo
 とできる
+結果は ws.pos に入れてその参照を返す (次に ws を使うまで有効)
 */
-std::vector<std::pair<int, int>> compress_y(const std::vector<std::vector<int>> &P, const std::vector<int> &perm, const std::vector<int> &X) {
+const std::vector<std::pair<int, int>> &compress_y(const std::vector<std::vector<int>> &P, const std::vector<int> &perm, const std::vector<int> &X, ScoreWorkspace &ws) {
     int N = X.size(), R = P.size();
     int l = 0, y = 0;
-    std::vector<std::pair<int, int>> ans(N);
+    auto &ans = ws.pos;
+    auto &used = ws.used;
+    ans.resize(N);
+    if (used.size() < N) used.resize(N, 0);
     while (l < R) {
-        std::vector<bool> used(N, false);
         int r = l;
+        ws.mark.clear();
         while (r < R) {
             int lx = X[P[perm[r]][0]];
             int rx = X[P[perm[r]].back()];
             if (rx >= used.size()) {
-                used.resize(rx + 1, false);
+                used.resize(rx + 1, 0);
             }
             bool ok = true;
             for (int j = lx; j <= rx; j++) {
@@ -352,7 +749,8 @@ std::vector<std::pair<int, int>> compress_y(const std::vector<std::vector<int>>
                     ok = false;
                     break;
                 }
-                used[j] = true;
+                used[j] = 1;
+                ws.mark.push_back(j);
             }
             if (!ok) break;
             r++;
@@ -363,9 +761,15 @@ std::vector<std::pair<int, int>> compress_y(const std::vector<std::vector<int>>
                 ans[v].second = y;
             }
         }
+        for (int j : ws.mark) used[j] = 0;
         y++;
         l = r;
     }
     return ans;
 }
+
+std::vector<std::pair<int, int>> compress_y(const std::vector<std::vector<int>> &P, const std::vector<int> &perm, const std::vector<int> &X) {
+    ScoreWorkspace ws;
+    return compress_y(P, perm, X, ws);
+}
 #endif
\ No newline at end of file
@@ -3,6 +3,9 @@
 #include <random>
 #include <vector>
 #include <algorithm>
+#include <iostream>
+#include <numeric>
+#include <limits>
 
 struct RandomGenerator {
   private:
@@ -11,6 +14,11 @@ struct RandomGenerator {
   public:
     RandomGenerator(const int seed = 1234) : mt(seed) {}
 
+    // シードを設定し直す
+    void set_seed(const int seed) {
+        mt.seed(seed);
+    }
+
     // [0, 2^32)
     uint32_t random_number() {
         return mt();
@@ -29,5 +37,17 @@ struct RandomGenerator {
         static constexpr double inf = (double)std::numeric_limits<uint32_t>::max();
         return random_number() < inf * p;
     }
-} rng;
+
+    // 内部状態を書き出す(チェックポイント用)
+    void save(std::ostream &os) const {
+        os << mt;
+    }
+
+    // saveで書き出した内部状態を読み込む
+    void load(std::istream &is) {
+        is >> mt;
+    }
+};
+// スレッドごとに独立した乱数生成器
+thread_local RandomGenerator rng;
 #endif
\ No newline at end of file